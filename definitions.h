@@ -68,6 +68,13 @@ enum { cSINGLE_THREADED = 0 };  //!< Compile Finroc in multi-threaded mode
 /*! Collect edge statistics (for profiling) ? */
 enum { cCOLLECT_EDGE_STATISTICS = 0 };
 
+/*! Record acquisitions, wait and hold times of structure mutex per call site (for profiling - see tStructureLockProfile) ? */
+#ifdef FINROC_PROFILE_STRUCTURE_LOCK
+enum { cPROFILE_STRUCTURE_LOCK = 1 };
+#else
+enum { cPROFILE_STRUCTURE_LOCK = 0 };
+#endif
+
 /*!
  * Definitions for framework element handles:
  * A handle is assigned to each framework element that is created.
@@ -93,9 +100,27 @@ enum { cCOLLECT_EDGE_STATISTICS = 0 };
  * Handle 0 is runtime environment.
  *
  * This means, we currently have max. 512K ports and max. 512K non-ports.
+ *
+ * For applications that need more framework elements, Finroc can be compiled
+ * with FINROC_64_BIT_HANDLES defined. Handles are 64 bit wide then and have the format
+ * [primary array index][secondary array index][tertiary array index][stamp]
+ * with 32 bits for the stamp. Tertiary arrays are only created when they are needed.
+ * This allows max. 2^31 ports and 2^31 non-ports.
+ * Ports are handles >= 0x8000000000000000 then.
  */
+#ifdef FINROC_64_BIT_HANDLES
+enum { c64_BIT_HANDLES = 1 };  //!< Use 64 bit framework element handles
+typedef uint64_t tHandle;      //!< Framework element handle type
+enum { cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH = 12 };
+enum { cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH = 10 };
+enum { cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH = 10 };
+#else
+enum { c64_BIT_HANDLES = 0 };  //!< Use 32 bit framework element handles
+typedef uint32_t tHandle;      //!< Framework element handle type
 enum { cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH = 10 };
 enum { cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH = 10 };
+enum { cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH = 0 };
+#endif
 constexpr rrlib::time::tDuration cHANDLE_UNIQUENESS_GUARANTEE_DURATION(std::chrono::minutes(1));
 
 }
@@ -0,0 +1,112 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tChildNameIndex.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/internal/tChildNameIndex.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+size_t tChildNameIndex::tKeyHash::operator()(const tKey& key) const
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < key.length; i++)
+  {
+    hash = (hash ^ static_cast<unsigned char>(key.data[i])) * 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+tChildNameIndex::tChildNameIndex() :
+  index()
+{}
+
+void tChildNameIndex::Add(tFrameworkElement::tLink& link)
+{
+  tKey key = { link.GetName().data(), link.GetName().length() };  // interned name remains valid until link is removed from index
+  index.insert(tIndex::value_type(key, &link));
+}
+
+void tChildNameIndex::Remove(tFrameworkElement::tLink& link)
+{
+  tKey key = { link.GetName().data(), link.GetName().length() };
+  std::pair<tIndex::iterator, tIndex::iterator> range = index.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == &link)
+    {
+      index.erase(it);
+      return;
+    }
+  }
+  assert(false && "Link not in index");
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
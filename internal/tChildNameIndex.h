@@ -0,0 +1,178 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tChildNameIndex.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tChildNameIndex
+ *
+ * \b tChildNameIndex
+ *
+ * Index of a framework element's child links by name.
+ * Created for framework elements with many children - so that
+ * looking up children by name does not require iterating over all of them.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__internal__tChildNameIndex_h__
+#define __core__internal__tChildNameIndex_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <cstring>
+#include <unordered_map>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tFrameworkElement.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Child name index
+/*!
+ * Index of a framework element's child links by name.
+ * Created lazily for framework elements with at least cMIN_CHILD_COUNT children -
+ * so that looking up children by name is expected O(1) instead of requiring
+ * to iterate over all of them.
+ *
+ * Links are indexed by the content of their names (hash and comparison of characters):
+ * So parts of longer strings (e.g. of qualified links) can be looked up without
+ * copying them - and without looking them up in the tNamePool first.
+ *
+ * Maintained by tFrameworkElement when children are added, removed, or renamed.
+ * An index may only be accessed with the child set mutex of the framework element it belongs to
+ * acquired (see tFrameworkElement::GetChildSetMutex()). The structure mutex does not suffice,
+ * as indices are created lazily by readers.
+ */
+class tChildNameIndex : private rrlib::util::tNoncopyable
+{
+  /*! Key in index: characters of a name (points to interned name of link - or into looked up string) */
+  struct tKey
+  {
+    const char* data;
+    size_t length;
+  };
+
+  /*! Hashes characters of key */
+  struct tKeyHash
+  {
+    size_t operator()(const tKey& key) const;
+  };
+
+  /*! Compares characters of keys */
+  struct tKeyEqual
+  {
+    bool operator()(const tKey& key1, const tKey& key2) const
+    {
+      return key1.length == key2.length && memcmp(key1.data, key2.data, key1.length) == 0;
+    }
+  };
+
+  typedef std::unordered_multimap<tKey, tFrameworkElement::tLink*, tKeyHash, tKeyEqual> tIndex;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Iterator over links with a specific name (see Find()) */
+  typedef tIndex::const_iterator tConstIterator;
+
+  /*! Minimum number of children for which a framework element creates a name index */
+  enum { cMIN_CHILD_COUNT = 32 };
+
+  tChildNameIndex();
+
+  /*!
+   * Adds link to index
+   *
+   * \param link Link to add (must have been added to parent's child set)
+   */
+  void Add(tFrameworkElement::tLink& link);
+
+  /*!
+   * \param name Name of child links to look for
+   * \return Range of all links with the specified name (in no particular order)
+   */
+  std::pair<tConstIterator, tConstIterator> Find(const tString& name) const
+  {
+    return Find(name, 0, name.length());
+  }
+
+  /*!
+   * \param string String that contains name of child links to look for (e.g. a qualified link)
+   * \param start Index of name's first character in 'string'
+   * \param length Length of name
+   * \return Range of all links with the specified name (in no particular order)
+   */
+  std::pair<tConstIterator, tConstIterator> Find(const tString& string, size_t start, size_t length) const
+  {
+    tKey key = { string.data() + start, length };
+    return index.equal_range(key);
+  }
+
+  /*!
+   * Removes link from index
+   * (must be called before link's name changes)
+   *
+   * \param link Link to remove
+   */
+  void Remove(tFrameworkElement::tLink& link);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Child links by name */
+  tIndex index;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
@@ -36,6 +36,7 @@
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
+#include "core/tLockOrderLevel.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -63,116 +64,173 @@ namespace internal
 //----------------------------------------------------------------------
 // Const values
 //----------------------------------------------------------------------
+constexpr tFrameworkElementRegister::tHandle tFrameworkElementRegister::cSTAMP_VALUES;
+constexpr tFrameworkElementRegister::tHandle tFrameworkElementRegister::cSTAMP_MASK;
+constexpr tFrameworkElementRegister::tHandle tFrameworkElementRegister::cFIRST_PORT_INDEX;
+constexpr tFrameworkElementRegister::tHandle tFrameworkElementRegister::cFIRST_PORT_HANDLE;
+constexpr tFrameworkElementRegister::tHandle tFrameworkElementRegister::cMAX_PORT_INDEX;
+constexpr tFrameworkElementRegister::tVersion tFrameworkElementRegister::cSLOT_WRITE_IN_PROGRESS;
 
 /*! Minimum duration to wait before reusing array slot */
 static const rrlib::time::tDuration cMIN_SLOT_REUSE_DURATION = definitions::cHANDLE_UNIQUENESS_GUARANTEE_DURATION / tFrameworkElementRegister::cSTAMP_VALUES;
 
+/*! Time interval covered by one generation of free slots */
+static const rrlib::time::tDuration cGENERATION_DURATION = std::max<rrlib::time::tDuration>(cMIN_SLOT_REUSE_DURATION / 4, std::chrono::milliseconds(1));
+
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
 
+/*!
+ * \param pointer Pointer to array chunk
+ * \return Array chunk that 'pointer' points to (created and installed using compare-and-swap if 'pointer' is NULL)
+ */
+template <typename TArray>
+static TArray& GetOrCreateArray(std::atomic<TArray*>& pointer)
+{
+  TArray* chunk = pointer.load(std::memory_order_acquire);
+  if (!chunk)
+  {
+    TArray* new_chunk = new TArray();
+    if (pointer.compare_exchange_strong(chunk, new_chunk))
+    {
+      chunk = new_chunk;
+    }
+    else
+    {
+      delete new_chunk; // another thread was faster - 'chunk' now points to its array
+    }
+  }
+  return *chunk;
+}
+
 tFrameworkElementRegister::tFrameworkElementRegister() :
   array_chunks(),
   next_index(1),
   next_port_index(cFIRST_PORT_INDEX),
-  unused_slot_queue()
+  element_slots(),
+  port_slots(),
+  mutex("Framework Element Register", static_cast<int>(tLockOrderLevel::INNER_MOST)),
+  version(0)
 {
-  array_chunks.fill(NULL);
+  for (auto it = array_chunks.begin(); it != array_chunks.end(); ++it)
+  {
+    it->store(NULL);
+  }
 }
 
 tFrameworkElementRegister::~tFrameworkElementRegister()
 {
   for (auto it = array_chunks.begin(); it != array_chunks.end(); ++it)
   {
-    delete *it;
+    delete it->load();
   }
 }
 
 tFrameworkElementRegister::tHandle tFrameworkElementRegister::Add(tFrameworkElement& framework_element, bool is_port)
 {
-  std::queue<tUnusedSlot>& queue = is_port ? unused_port_slot_queue : unused_slot_queue;
-  if (!queue.empty())
+  tSlotPool& pool = is_port ? port_slots : element_slots;
+  bool fresh_slots_exhausted = is_port ? (next_port_index.load() > cMAX_PORT_INDEX) : (next_index.load() >= cFIRST_PORT_INDEX);
+  if (pool.reusable_slot_count.load() > 0 || (fresh_slots_exhausted && pool.free_slot_count.load() > 0))
   {
-    if (queue.front().delete_time + cMIN_SLOT_REUSE_DURATION < rrlib::time::Now())
+    rrlib::thread::tLock lock(mutex);
+    if (pool.reusable_handles.empty())
     {
-      tHandle ex_handle = queue.front().ex_handle;
-      queue.pop();
-
-      uint32_t new_stamp = (ex_handle + 1) & cSTAMP_MASK;
-      uint32_t index = ex_handle >> cSTAMP_BIT_WIDTH;
-      uint32_t primary_index = index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
-      assert(array_chunks[primary_index]->array[index & cSECONDARY_INDEX_MASK] == NULL);
-      array_chunks[primary_index]->array[index & cSECONDARY_INDEX_MASK] = &framework_element;
+      RecycleExpiredGenerations(pool, rrlib::time::Now(false));  // only necessary if no more fresh slots are available
+    }
+    if (!pool.reusable_handles.empty())
+    {
+      tHandle ex_handle = pool.reusable_handles.back();
+      pool.reusable_handles.pop_back();
+      pool.free_slot_count--;
+      pool.reusable_slot_count--;
 
-      return (index << cSTAMP_BIT_WIDTH) | new_stamp;
+      tHandle new_stamp = (ex_handle + 1) & cSTAMP_MASK;
+      tHandle index = ex_handle >> cSTAMP_BIT_WIDTH;
+      tHandle handle = (index << cSTAMP_BIT_WIDTH) | new_stamp;
+      tElementArray& chunk = *GetElementArray(index);
+      assert(chunk.array[index & cELEMENT_INDEX_MASK].load() == NULL);
+      SetSlot(chunk, index, &framework_element, handle);
+      return handle;
     }
   }
 
   // put in new slot
-  uint32_t use_index = 0;
+  tHandle use_index = ClaimFreshSlot(is_port);
+  tElementArray& chunk = GetOrCreateElementArray(use_index);
+  assert(chunk.array[use_index & cELEMENT_INDEX_MASK].load() == NULL);
+  tHandle handle = use_index << cSTAMP_BIT_WIDTH;
+  SetSlot(chunk, use_index, &framework_element, handle);
+  return handle;
+}
+
+tFrameworkElementRegister::tHandle tFrameworkElementRegister::ClaimFreshSlot(bool is_port)
+{
   if (is_port)
   {
-    use_index = next_port_index;
-    next_port_index++;
+    tHandle use_index = next_port_index.fetch_add(1);
     if (use_index > cMAX_PORT_INDEX)
     {
       FINROC_LOG_PRINT(ERROR, "Maximum number of ports exceeded (", cFIRST_PORT_INDEX, "). You can adjust definitions.h if you need that many ports.");
       throw std::runtime_error("Maximum number of ports exceeded. You can adjust definitions.h if you need that many ports.");
     }
-  }
-  else
-  {
-    use_index = next_index;
-    next_index++;
-    if (use_index >= cFIRST_PORT_INDEX)
-    {
-      FINROC_LOG_PRINT(ERROR, "Maximum number of non-port framework elements exceeded (", cFIRST_PORT_INDEX, "). You can adjust definitions.h if you need that many.");
-      throw std::runtime_error("Maximum number of non-port framework elements exceeded. You can adjust definitions.h if you need that many.");
-    }
+    return use_index;
   }
 
-  uint32_t primary_index = use_index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
-  if (!array_chunks[primary_index])
+  tHandle use_index = next_index.fetch_add(1);
+  if (use_index >= cFIRST_PORT_INDEX)
   {
-    array_chunks[primary_index] = new tSecondaryArray();
+    FINROC_LOG_PRINT(ERROR, "Maximum number of non-port framework elements exceeded (", cFIRST_PORT_INDEX, "). You can adjust definitions.h if you need that many.");
+    throw std::runtime_error("Maximum number of non-port framework elements exceeded. You can adjust definitions.h if you need that many.");
   }
-  assert(array_chunks[primary_index]->array[use_index & cSECONDARY_INDEX_MASK] == NULL);
-  array_chunks[primary_index]->array[use_index & cSECONDARY_INDEX_MASK] = &framework_element;
-  tHandle handle = use_index << cSTAMP_BIT_WIDTH;
-  return handle;
+  return use_index;
 }
 
-size_t tFrameworkElementRegister::GetAllElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle)
+size_t tFrameworkElementRegister::FindElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle, const tMetadataFilter& filter)
 {
   if (max_elements == 0)
   {
     return 0;
   }
 
+  if (start_from_handle < cFIRST_PORT_HANDLE && (filter.flag_mask.Raw() & filter.flag_values.Raw() & tFrameworkElementFlags(tFrameworkElementFlag::PORT).Raw()))
+  {
+    start_from_handle = cFIRST_PORT_HANDLE; // only ports are requested
+  }
+
   size_t result = 0;
-  uint32_t start_index = start_from_handle >> cSTAMP_BIT_WIDTH;
-  uint32_t last_index = (start_from_handle >= cFIRST_PORT_HANDLE) ? (next_port_index - 1) : (next_index - 1);
-  uint32_t primary_start_index = start_index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
-  uint32_t primary_end_index = last_index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
+  const uint32_t flag_mask = filter.flag_mask.Raw();
+  const uint32_t flag_values = filter.flag_values.Raw();
+  tHandle start_index = start_from_handle >> cSTAMP_BIT_WIDTH;
+  tHandle last_index = (start_from_handle >= cFIRST_PORT_HANDLE) ? LastUsedIndex(next_port_index.load(), cMAX_PORT_INDEX) : LastUsedIndex(next_index.load(), cFIRST_PORT_INDEX - 1);
 
-  for (size_t primary_index = primary_start_index; primary_index <= primary_end_index; primary_index++)
+  for (tHandle chunk_start_index = start_index & (~static_cast<tHandle>(cELEMENT_INDEX_MASK)); chunk_start_index <= last_index; chunk_start_index += cELEMENT_ARRAY_SIZE)
   {
-    if (array_chunks[primary_index])
+    tElementArray* chunk = GetElementArray(chunk_start_index);
+    if (chunk)
     {
-      uint32_t secondary_start_index = 0;
-      if (primary_index == primary_start_index)
+      tHandle first_index = std::max(chunk_start_index, start_index);
+      tHandle last_chunk_index = std::min<tHandle>(chunk_start_index + cELEMENT_INDEX_MASK, last_index);
+      if (first_index == start_index)
       {
-        secondary_start_index = start_index & cSECONDARY_INDEX_MASK;
-        tFrameworkElement* framework_element = array_chunks[primary_index]->array[secondary_start_index];
+        tFrameworkElement* framework_element = chunk->array[first_index & cELEMENT_INDEX_MASK].load(std::memory_order_acquire);
         if (framework_element && framework_element->GetHandle() < start_from_handle)
         {
-          secondary_start_index++;
+          first_index++;
         }
       }
-      uint32_t secondary_end_index = (primary_index == primary_end_index) ? (last_index & cSECONDARY_INDEX_MASK) : cSECONDARY_INDEX_MASK;
-      for (size_t secondary_index = secondary_start_index; secondary_index <= secondary_end_index; secondary_index++)
+      for (tHandle index = first_index; index <= last_chunk_index; index++)
       {
-        tFrameworkElement* framework_element = array_chunks[primary_index]->array[secondary_index];
+        tHandle i = index & cELEMENT_INDEX_MASK;
+        if ((chunk->flags[i].load(std::memory_order_relaxed) & flag_mask) != flag_values ||
+            (filter.data_type_uid >= 0 && chunk->data_types[i].load(std::memory_order_relaxed) != filter.data_type_uid) ||
+            (filter.match_parent && chunk->parents[i].load(std::memory_order_relaxed) != filter.parent_handle) ||
+            chunk->incoming_connections[i].load(std::memory_order_relaxed) < filter.min_incoming_connections ||
+            chunk->outgoing_connections[i].load(std::memory_order_relaxed) < filter.min_outgoing_connections)
+        {
+          continue;
+        }
+        tFrameworkElement* framework_element = chunk->array[i].load(std::memory_order_acquire);
         if (framework_element)
         {
           *result_buffer = framework_element;
@@ -190,28 +248,242 @@ size_t tFrameworkElementRegister::GetAllElements(tFrameworkElement** result_buff
   // If we have place left in result buffer, also return ports
   if (start_from_handle < cFIRST_PORT_HANDLE)
   {
-    return GetAllElements(result_buffer, max_elements - result, cFIRST_PORT_HANDLE) + result;
+    return FindElements(result_buffer, max_elements - result, cFIRST_PORT_HANDLE, filter) + result;
+  }
+
+  return result;
+}
+
+size_t tFrameworkElementRegister::GetSnapshot(tSnapshotEntry* result_buffer, size_t max_entries, tSnapshotCursor& cursor, tVersion changed_since_version)
+{
+  size_t result = 0;
+  while (result < max_entries && (!cursor.Done()))
+  {
+    bool ports = cursor.next_index >= cFIRST_PORT_INDEX;
+    tHandle last_index = ports ? LastUsedIndex(next_port_index.load(), cMAX_PORT_INDEX) : LastUsedIndex(next_index.load(), cFIRST_PORT_INDEX - 1);
+    if (cursor.next_index > last_index)
+    {
+      cursor.next_index = ports ? (cMAX_PORT_INDEX + 1) : cFIRST_PORT_INDEX; // continue with next area
+      continue;
+    }
+
+    tElementArray* chunk = GetElementArray(cursor.next_index);
+    tHandle chunk_end_index = std::min<tHandle>((cursor.next_index | cELEMENT_INDEX_MASK), last_index);
+    if (!chunk)
+    {
+      cursor.next_index = chunk_end_index + 1;
+      continue;
+    }
+
+    for (; cursor.next_index <= chunk_end_index && result < max_entries; cursor.next_index++)
+    {
+      tHandle element_index = cursor.next_index & cELEMENT_INDEX_MASK;
+      tSnapshotEntry entry;
+      tVersion version_check = 0;
+      do
+      {
+        entry.version = chunk->versions[element_index].load();
+        if (entry.version == cSLOT_WRITE_IN_PROGRESS)
+        {
+          continue;
+        }
+        entry.element = chunk->array[element_index].load();
+        entry.handle = chunk->handles[element_index].load();
+        version_check = chunk->versions[element_index].load();
+      }
+      while (entry.version == cSLOT_WRITE_IN_PROGRESS || entry.version != version_check);
+
+      if (entry.version > changed_since_version && (entry.element || changed_since_version > 0))
+      {
+        *result_buffer = entry;
+        result_buffer++;
+        result++;
+      }
+    }
   }
+  return result;
+}
+
+tFrameworkElementRegister::tSlotStatistics tFrameworkElementRegister::GetSlotStatistics(bool ports)
+{
+  rrlib::thread::tLock lock(mutex);
+  tSlotPool& pool = ports ? port_slots : element_slots;
+  RecycleExpiredGenerations(pool, rrlib::time::Now(false));
+  tHandle next = ports ? next_port_index.load() : next_index.load();
+  tHandle end = ports ? (cMAX_PORT_INDEX + 1) : cFIRST_PORT_INDEX;
 
+  tSlotStatistics result;
+  result.free_slots = pool.free_slot_count.load();
+  result.reusable_slots = pool.reusable_handles.size();
+  result.never_used_slots = next < end ? (end - next) : 0;
   return result;
 }
 
+tFrameworkElementRegister::tElementArray& tFrameworkElementRegister::GetOrCreateElementArray(tHandle index)
+{
+#ifdef FINROC_64_BIT_HANDLES
+  tSecondaryArray& secondary = GetOrCreateArray(array_chunks[index >> (definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH + cELEMENT_ARRAY_INDEX_BIT_WIDTH)]);
+  return GetOrCreateArray(secondary.array[(index >> cELEMENT_ARRAY_INDEX_BIT_WIDTH) & cSECONDARY_INDEX_MASK]);
+#else
+  return GetOrCreateArray(array_chunks[index >> cELEMENT_ARRAY_INDEX_BIT_WIDTH]);
+#endif
+}
+
+void tFrameworkElementRegister::MarkChanged(tHandle handle)
+{
+  tHandle index = handle >> cSTAMP_BIT_WIDTH;
+  tElementArray* chunk = GetElementArray(index);
+  rrlib::thread::tLock lock(mutex);
+  if (chunk && chunk->array[index & cELEMENT_INDEX_MASK].load() && chunk->handles[index & cELEMENT_INDEX_MASK].load() == handle)
+  {
+    SetSlot(*chunk, index, chunk->array[index & cELEMENT_INDEX_MASK].load(), handle);
+  }
+}
+
 void tFrameworkElementRegister::Remove(tHandle handle)
 {
-  uint32_t index = handle >> cSTAMP_BIT_WIDTH;
-  uint32_t primary_index = index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
-  uint32_t secondary_index = index & cSECONDARY_INDEX_MASK;
-  assert(array_chunks[primary_index] && array_chunks[primary_index]->array[secondary_index] && array_chunks[primary_index]->array[secondary_index]->GetHandle() == handle);
-  array_chunks[primary_index]->array[secondary_index] = NULL;
-  unused_slot_queue.push(tUnusedSlot(handle));
+  tHandle index = handle >> cSTAMP_BIT_WIDTH;
+  tHandle element_index = index & cELEMENT_INDEX_MASK;
+  tElementArray* chunk = GetElementArray(index);
+  assert(chunk && chunk->array[element_index].load() && chunk->handles[element_index].load() == handle);  // does not access element - so register can also be benchmarked with placeholder elements
+
+  tSlotPool& pool = index >= cFIRST_PORT_INDEX ? port_slots : element_slots;
+
+  rrlib::thread::tLock lock(mutex);
+  SetSlot(*chunk, index, NULL, handle);
+  rrlib::time::tTimestamp now = rrlib::time::Now(false);
+  if (pool.generations.empty() || pool.generations.back().start_time + cGENERATION_DURATION < now)
+  {
+    pool.generations.emplace_back(now);
+  }
+  pool.generations.back().ex_handles.push_back(handle);
+  pool.free_slot_count++;
+  RecycleExpiredGenerations(pool, now);
+}
+
+void tFrameworkElementRegister::RecycleExpiredGenerations(tSlotPool& pool, rrlib::time::tTimestamp now)
+{
+  if (pool.generations.empty())
+  {
+    return;
+  }
+  while ((!pool.generations.empty()) && pool.generations.front().start_time + cGENERATION_DURATION + cMIN_SLOT_REUSE_DURATION < now)
+  {
+    std::vector<tHandle>& ex_handles = pool.generations.front().ex_handles;
+    if (pool.reusable_handles.empty())
+    {
+      pool.reusable_handles.swap(ex_handles);
+    }
+    else
+    {
+      pool.reusable_handles.insert(pool.reusable_handles.end(), ex_handles.begin(), ex_handles.end());
+    }
+    pool.generations.pop_front();
+  }
+  pool.reusable_slot_count.store(pool.reusable_handles.size());
+}
+
+
+void tFrameworkElementRegister::SetSlot(tElementArray& chunk, tHandle index, tFrameworkElement* element, tHandle handle)
+{
+  tHandle element_index = index & cELEMENT_INDEX_MASK;
+  if (chunk.handles[element_index].load() != handle || chunk.array[element_index].load() == NULL)
+  {
+    // new element or element removed: reset mirrored metadata
+    chunk.flags[element_index].store(0, std::memory_order_relaxed);
+    chunk.data_types[element_index].store(-1, std::memory_order_relaxed);
+    chunk.parents[element_index].store(0, std::memory_order_relaxed);
+    chunk.incoming_connections[element_index].store(0, std::memory_order_relaxed);
+    chunk.outgoing_connections[element_index].store(0, std::memory_order_relaxed);
+  }
+  chunk.versions[element_index].store(cSLOT_WRITE_IN_PROGRESS);
+  chunk.array[element_index].store(element);
+  chunk.handles[element_index].store(handle);
+  chunk.versions[element_index].store(version.fetch_add(1) + 1);
+}
+
+void tFrameworkElementRegister::UpdateConnectionCount(tHandle handle, int incoming_delta, int outgoing_delta)
+{
+  tHandle element_index = 0;
+  tElementArray* chunk = GetElementSlot(handle, element_index);
+  if (chunk)
+  {
+    chunk->incoming_connections[element_index].fetch_add(static_cast<uint32_t>(incoming_delta), std::memory_order_relaxed);
+    chunk->outgoing_connections[element_index].fetch_add(static_cast<uint32_t>(outgoing_delta), std::memory_order_relaxed);
+  }
+}
+
+void tFrameworkElementRegister::UpdateDataType(tHandle handle, int data_type_uid)
+{
+  tHandle element_index = 0;
+  tElementArray* chunk = GetElementSlot(handle, element_index);
+  if (chunk)
+  {
+    chunk->data_types[element_index].store(data_type_uid, std::memory_order_relaxed);
+  }
+}
+
+void tFrameworkElementRegister::UpdateFlags(tHandle handle, tFrameworkElementFlags flags)
+{
+  tHandle element_index = 0;
+  tElementArray* chunk = GetElementSlot(handle, element_index);
+  if (chunk)
+  {
+    chunk->flags[element_index].store(flags.Raw(), std::memory_order_relaxed);
+  }
+}
+
+void tFrameworkElementRegister::UpdateParent(tHandle handle, tHandle parent_handle)
+{
+  tHandle element_index = 0;
+  tElementArray* chunk = GetElementSlot(handle, element_index);
+  if (chunk)
+  {
+    chunk->parents[element_index].store(parent_handle, std::memory_order_relaxed);
+  }
 }
 
+tFrameworkElementRegister::tElementArray::tElementArray() :
+  array(),
+  handles(),
+  versions(),
+  flags(),
+  data_types(),
+  parents(),
+  incoming_connections(),
+  outgoing_connections()
+{
+  for (size_t i = 0; i < cELEMENT_ARRAY_SIZE; i++)
+  {
+    array[i].store(NULL);
+    handles[i].store(0);
+    versions[i].store(0);
+    flags[i].store(0);
+    data_types[i].store(-1);
+    parents[i].store(0);
+    incoming_connections[i].store(0);
+    outgoing_connections[i].store(0);
+  }
+}
 
+#ifdef FINROC_64_BIT_HANDLES
 tFrameworkElementRegister::tSecondaryArray::tSecondaryArray() :
   array()
 {
-  array.fill(NULL);
+  for (auto it = array.begin(); it != array.end(); ++it)
+  {
+    it->store(NULL);
+  }
+}
+
+tFrameworkElementRegister::tSecondaryArray::~tSecondaryArray()
+{
+  for (auto it = array.begin(); it != array.end(); ++it)
+  {
+    delete it->load();
+  }
 }
+#endif
 
 //----------------------------------------------------------------------
 // End of namespace declaration
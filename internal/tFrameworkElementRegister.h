@@ -39,6 +39,12 @@
  * Its entries point to secondary arrays, which have
  * 2^cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH entries - which contain the actual values.
  * Secondary are created when they are needed. This way, the register can "grow".
+ * With 64 bit handles (FINROC_64_BIT_HANDLES), secondary arrays point to tertiary arrays
+ * with 2^cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH entries instead - which then contain the actual values.
+ * Tertiary arrays are also created when they are needed.
+ *
+ * Handles are assigned without acquiring the runtime's structure mutex.
+ * Lookup via Get() is wait-free.
  *
  * For documentation on framework element handle format - see definitions.h
  */
@@ -49,7 +55,9 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <vector>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -85,6 +93,31 @@ namespace internal
  * Its entries point to secondary arrays, which have
  * 2^cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH entries - which contain the actual values.
  * Secondary are created when they are needed. This way, the register can "grow".
+ * With 64 bit handles (FINROC_64_BIT_HANDLES), secondary arrays point to tertiary arrays
+ * with 2^cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH entries instead - which then contain the actual values.
+ * Tertiary arrays are also created when they are needed.
+ *
+ * Adding elements is thread-safe and does not require the runtime's structure mutex:
+ * Fresh slots are claimed using atomic counters and secondary arrays are installed
+ * using compare-and-swap. Only reusing slots of deleted elements requires the
+ * register's own (inner-most) mutex.
+ * Lookup via Get() is wait-free.
+ *
+ * Slots of deleted elements are collected in generations - one per time interval
+ * of cGENERATION_DURATION (separately for ports and non-ports).
+ * Once a whole generation has expired, its slots are moved to the list of reusable
+ * slots in bulk. This is done by Remove() (which checks the current time anyway) -
+ * so Add() only locks the mutex if there are reusable slots (or if all fresh slots
+ * have been used).
+ *
+ * Every change to a slot (adding, removing or marking an element as changed)
+ * assigns a new structure version to the slot. Together with the handle of the
+ * last element in the slot, this allows creating snapshots of the register
+ * without blocking - and to obtain only the slots that changed since a certain version.
+ *
+ * Furthermore, frequently queried metadata of elements (flags, data type, parent, number of connections)
+ * is mirrored in dense arrays indexed by slot. This way, the whole runtime can be scanned for elements
+ * with certain properties (see FindElements()) without dereferencing every element.
  *
  * For documentation on framework element handle format - see definitions.h
  */
@@ -96,7 +129,20 @@ class tFrameworkElementRegister : private rrlib::util::tNoncopyable
 //----------------------------------------------------------------------
 public:
 
-  typedef uint32_t tHandle;
+  typedef tFrameworkElement::tHandle tHandle;
+
+  /*! Structure version (incremented with every change to the register) */
+  typedef uint64_t tVersion;
+
+  /*! Bit width of index part of handle */
+  enum { cINDEX_BIT_WIDTH = definitions::cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH + definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH + definitions::cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH };
+
+  /*! Bit width of index in arrays that contain the actual values (secondary arrays - or tertiary arrays with 64 bit handles) */
+#ifdef FINROC_64_BIT_HANDLES
+  enum { cELEMENT_ARRAY_INDEX_BIT_WIDTH = definitions::cHANDLE_TERTIARY_ARRAY_INDEX_BIT_WIDTH };
+#else
+  enum { cELEMENT_ARRAY_INDEX_BIT_WIDTH = definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH };
+#endif
 
   /*! Number of elements in primary array */
   enum { cPRIMARY_ARRAY_SIZE = 1 << definitions::cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH };
@@ -107,24 +153,110 @@ public:
   /*! Mask to extract secondary index */
   enum { cSECONDARY_INDEX_MASK = cSECONDARY_ARRAY_SIZE - 1 };
 
+  /*! Number of elements in arrays that contain the actual values */
+  enum { cELEMENT_ARRAY_SIZE = 1 << cELEMENT_ARRAY_INDEX_BIT_WIDTH };
+
+  /*! Mask to extract index in arrays that contain the actual values */
+  enum { cELEMENT_INDEX_MASK = cELEMENT_ARRAY_SIZE - 1 };
+
   /*! Bit width of stamp */
-  enum { cSTAMP_BIT_WIDTH = (sizeof(tHandle) * 8) - (definitions::cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH + definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH) };
+  enum { cSTAMP_BIT_WIDTH = (sizeof(tHandle) * 8) - cINDEX_BIT_WIDTH };
 
   /*! Number of possible stamp values */
-  enum { cSTAMP_VALUES = 1 << cSTAMP_BIT_WIDTH };
+  static constexpr tHandle cSTAMP_VALUES = static_cast<tHandle>(1) << cSTAMP_BIT_WIDTH;
 
   /*! Mask to extract stamp from handle */
-  enum { cSTAMP_MASK = cSTAMP_VALUES - 1 };
+  static constexpr tHandle cSTAMP_MASK = cSTAMP_VALUES - 1;
 
   /*! First port index */
-  enum { cFIRST_PORT_INDEX = 1 << (definitions::cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH + definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH - 1) };
+  static constexpr tHandle cFIRST_PORT_INDEX = static_cast<tHandle>(1) << (cINDEX_BIT_WIDTH - 1);
 
   /*! First port handle */
   static constexpr tHandle cFIRST_PORT_HANDLE = cFIRST_PORT_INDEX << cSTAMP_BIT_WIDTH;
 
   /*! Maximum port index */
-  enum { cMAX_PORT_INDEX = (1 << (definitions::cHANDLE_PRIMARY_ARRAY_INDEX_BIT_WIDTH + definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH)) - 1 };
+  static constexpr tHandle cMAX_PORT_INDEX = (static_cast<tHandle>(1) << cINDEX_BIT_WIDTH) - 1;
+
+
+  /*! Statistics on slots in register (separately for ports and non-ports) */
+  struct tSlotStatistics
+  {
+    /*! Number of slots of deleted elements that have not been reused yet (includes reusable slots) */
+    size_t free_slots;
+
+    /*! Number of free slots that can be reused immediately */
+    size_t reusable_slots;
+
+    /*! Number of slots that have never been used */
+    size_t never_used_slots;
+  };
 
+  /*! Entry in snapshot of register */
+  struct tSnapshotEntry
+  {
+    /*! Handle of element - or handle of the last element in this slot if element has been removed */
+    tHandle handle;
+
+    /*!
+     * Element - or NULL if element has been removed.
+     * As elements are deleted by the garbage deleter, the pointer remains valid for a short while only.
+     * If element is to be used later, it should be retrieved again using its handle.
+     */
+    tFrameworkElement* element;
+
+    /*! Structure version of last change to this slot */
+    tVersion version;
+  };
+
+  /*! Position of snapshot in register - allows to page through register with multiple calls to GetSnapshot() */
+  struct tSnapshotCursor
+  {
+    /*! Index of next slot to visit */
+    tHandle next_index;
+
+    tSnapshotCursor() : next_index(0) {}
+
+    /*!
+     * \return True if all slots have been visited
+     */
+    bool Done() const
+    {
+      return next_index > cMAX_PORT_INDEX;
+    }
+  };
+
+  /*!
+   * Filter for FindElements()
+   * (default-constructed filter accepts all elements)
+   */
+  struct tMetadataFilter
+  {
+    /*! Flags to check */
+    tFrameworkElementFlags flag_mask;
+
+    /*! Required values of flags in 'flag_mask' */
+    tFrameworkElementFlags flag_values;
+
+    /*! Uid of required data type (-1 accepts any data type) */
+    int data_type_uid;
+
+    /*! Handle of required parent (primary link) - only checked if 'match_parent' is true */
+    tHandle parent_handle;
+    bool match_parent;
+
+    /*! Minimum number of incoming and outgoing connections (of ports) */
+    uint32_t min_incoming_connections, min_outgoing_connections;
+
+    tMetadataFilter() :
+      flag_mask(),
+      flag_values(),
+      data_type_uid(-1),
+      parent_handle(0),
+      match_parent(false),
+      min_incoming_connections(0),
+      min_outgoing_connections(0)
+    {}
+  };
 
   /*!
    * \param positive_indices Positive handles? (or rather negative??)
@@ -135,6 +267,7 @@ public:
 
   /*!
    * Add element to this register
+   * (thread-safe; may be called without holding the runtime's structure mutex)
    *
    * \param framework_element Element to add
    * \param is_port Is this framework element a port?
@@ -148,11 +281,11 @@ public:
    */
   tFrameworkElement* Get(tHandle handle)
   {
-    uint32_t index = handle >> cSTAMP_BIT_WIDTH;
-    uint32_t primary_index = index >> definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH;
-    if (array_chunks[primary_index])
+    tHandle index = handle >> cSTAMP_BIT_WIDTH;
+    tElementArray* chunk = GetElementArray(index);
+    if (chunk)
     {
-      tFrameworkElement* result = array_chunks[primary_index]->array[index & cSECONDARY_INDEX_MASK];
+      tFrameworkElement* result = chunk->array[index & cELEMENT_INDEX_MASK].load(std::memory_order_acquire);
       return (result && result->GetHandle() == handle) ? result : NULL;
     }
     return NULL;
@@ -167,7 +300,92 @@ public:
    * \param start_from_handle Handle to start from. Together with 'max_elements', can be used to get all elements with multiple calls to this function - using a small result buffer.
    * \return Number of elements that were copied
    */
-  size_t GetAllElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle);
+  size_t GetAllElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle)
+  {
+    return FindElements(result_buffer, max_elements, start_from_handle, tMetadataFilter());
+  }
+
+  /*!
+   * Copies all framework elements that currently exist and match the specified filter to the specified buffer.
+   * Only the metadata arrays are scanned - elements are not dereferenced.
+   *
+   * \param result_buffer Pointer to the first element of the result buffer
+   * \param max_elements Maximum number of elements to copy (size of result buffer)
+   * \param start_from_handle Handle to start from. Together with 'max_elements', can be used to get all elements with multiple calls to this function - using a small result buffer.
+   * \param filter Filter that elements must match
+   * \return Number of elements that were copied
+   */
+  size_t FindElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle, const tMetadataFilter& filter);
+
+  /*!
+   * \param ports Return statistics on port slots? (otherwise statistics on slots of non-port elements are returned)
+   * \return Statistics on slots in register
+   */
+  tSlotStatistics GetSlotStatistics(bool ports);
+
+  /*!
+   * Copies entries of all slots that changed since the specified structure version to the specified buffer.
+   * Does not block and can be called without holding the runtime's structure mutex.
+   * If a slot has been reused since 'changed_since_version', only the current element is reported -
+   * so if the reported handle differs from a known handle with the same slot index, the element
+   * with the known handle has been removed.
+   *
+   * \param result_buffer Pointer to the first element of the result buffer
+   * \param max_entries Maximum number of entries to copy (size of result buffer)
+   * \param cursor Position in register to continue from. Is advanced to the slot after the last visited slot.
+   * \param changed_since_version Only return slots that changed after this version (0 returns all existing elements - and no removed ones)
+   * \return Number of entries that were copied
+   */
+  size_t GetSnapshot(tSnapshotEntry* result_buffer, size_t max_entries, tSnapshotCursor& cursor, tVersion changed_since_version);
+
+  /*!
+   * \return Current structure version. Obtain this before creating a snapshot and use it as 'changed_since_version' for the next one.
+   */
+  tVersion GetVersion() const
+  {
+    return version.load();
+  }
+
+  /*!
+   * Assigns new structure version to slot of element with specified handle
+   * (e.g. when element has been initialized or connected)
+   *
+   * \param handle Handle of element
+   */
+  void MarkChanged(tHandle handle);
+
+  /*!
+   * Adjusts mirrored number of connections of port with specified handle
+   *
+   * \param handle Handle of port
+   * \param incoming_delta Change in number of incoming connections
+   * \param outgoing_delta Change in number of outgoing connections
+   */
+  void UpdateConnectionCount(tHandle handle, int incoming_delta, int outgoing_delta);
+
+  /*!
+   * Updates mirrored data type of port with specified handle
+   *
+   * \param handle Handle of port
+   * \param data_type_uid Uid of port's data type
+   */
+  void UpdateDataType(tHandle handle, int data_type_uid);
+
+  /*!
+   * Updates mirrored flags of element with specified handle
+   *
+   * \param handle Handle of element
+   * \param flags Current flags of element
+   */
+  void UpdateFlags(tHandle handle, tFrameworkElementFlags flags);
+
+  /*!
+   * Updates mirrored parent (of primary link) of element with specified handle
+   *
+   * \param handle Handle of element
+   * \param parent_handle Handle of parent
+   */
+  void UpdateParent(tHandle handle, tHandle parent_handle);
 
   /*!
    * Remove element with specified handle from register
@@ -181,43 +399,181 @@ public:
 //----------------------------------------------------------------------
 private:
 
-  /*! Secondary array chunk */
+  /*! Array chunk that contains the actual values (secondary array - or tertiary array with 64 bit handles) */
+  struct tElementArray
+  {
+    /*! Elements in slots */
+    std::array<std::atomic<tFrameworkElement*>, cELEMENT_ARRAY_SIZE> array;
+
+    /*! Handles of (last) elements in slots */
+    std::array<std::atomic<tHandle>, cELEMENT_ARRAY_SIZE> handles;
+
+    /*! Structure version of last change to each slot (cSLOT_WRITE_IN_PROGRESS while slot is being changed) */
+    std::array<std::atomic<tVersion>, cELEMENT_ARRAY_SIZE> versions;
+
+    // Mirrored metadata of elements in slots
+
+    /*! Raw flags */
+    std::array<std::atomic<uint32_t>, cELEMENT_ARRAY_SIZE> flags;
+
+    /*! Uids of port data types (-1 for non-ports) */
+    std::array<std::atomic<int>, cELEMENT_ARRAY_SIZE> data_types;
+
+    /*! Handles of parents */
+    std::array<std::atomic<tHandle>, cELEMENT_ARRAY_SIZE> parents;
+
+    /*! Number of incoming and outgoing connections */
+    std::array<std::atomic<uint32_t>, cELEMENT_ARRAY_SIZE> incoming_connections, outgoing_connections;
+
+    tElementArray();
+  };
+
+  /*! Slot version while slot is being changed */
+  static constexpr tVersion cSLOT_WRITE_IN_PROGRESS = static_cast<tVersion>(-1);
+
+#ifdef FINROC_64_BIT_HANDLES
+  /*! Secondary array chunk with pointers to tertiary arrays (installed lazily using compare-and-swap) */
   struct tSecondaryArray
   {
-    std::array<tFrameworkElement*, cSECONDARY_ARRAY_SIZE> array;
+    std::array<std::atomic<tElementArray*>, cSECONDARY_ARRAY_SIZE> array;
 
     tSecondaryArray();
+    ~tSecondaryArray();
   };
+#else
+  typedef tElementArray tSecondaryArray;
+#endif
 
-  /*! Information on unused slot */
-  struct tUnusedSlot
+  /*! Slots of elements deleted within the same time interval */
+  struct tGeneration
   {
-    /*! Time when element in this slot was deleted */
-    rrlib::time::tTimestamp delete_time;
+    /*! Time when first element of this generation was deleted */
+    rrlib::time::tTimestamp start_time;
 
-    /*! Handle of deleted element */
-    tHandle ex_handle;
+    /*! Handles of deleted elements */
+    std::vector<tHandle> ex_handles;
 
-    explicit tUnusedSlot(tHandle ex_handle) :
-      delete_time(rrlib::time::Now()),
-      ex_handle(ex_handle)
+    explicit tGeneration(rrlib::time::tTimestamp start_time) :
+      start_time(start_time),
+      ex_handles()
     {}
   };
 
-  /*! Pointers to any secondary arrays */
-  std::array < tSecondaryArray*, cPRIMARY_ARRAY_SIZE + 1 > array_chunks;
+  /*! Free slots of one handle area (ports or non-ports) */
+  struct tSlotPool
+  {
+    /*! Generations of free slots that cannot be reused yet (oldest first) */
+    std::deque<tGeneration> generations;
+
+    /*! Handles of deleted elements whose slots can be reused */
+    std::vector<tHandle> reusable_handles;
+
+    /*! Number of handles in 'generations' and 'reusable_handles' */
+    std::atomic<size_t> free_slot_count;
+
+    /*! Number of handles in 'reusable_handles' - allows Add() to skip locking the mutex if there are none */
+    std::atomic<size_t> reusable_slot_count;
+
+    tSlotPool() :
+      generations(),
+      reusable_handles(),
+      free_slot_count(0),
+      reusable_slot_count(0)
+    {}
+  };
+
+  /*! Pointers to any secondary arrays (installed lazily using compare-and-swap) */
+  std::array < std::atomic<tSecondaryArray*>, cPRIMARY_ARRAY_SIZE + 1 > array_chunks;
 
   /*! Next index for non-ports */
-  uint32_t next_index;
+  std::atomic<tHandle> next_index;
 
   /*! Next index for ports */
-  uint32_t next_port_index;
+  std::atomic<tHandle> next_port_index;
+
+  /*! Free slots of non-port elements */
+  tSlotPool element_slots;
+
+  /*! Free slots of ports */
+  tSlotPool port_slots;
 
-  /*! Stores unused slots */
-  std::queue<tUnusedSlot> unused_slot_queue;
+  /*! Mutex for slot pools (inner-most lock - is acquired with runtime's structure mutex held) */
+  rrlib::thread::tOrderedMutex mutex;
 
-  /*! Stores unused slots */
-  std::queue<tUnusedSlot> unused_port_slot_queue;
+  /*! Current structure version */
+  std::atomic<tVersion> version;
+
+
+  /*!
+   * Claims a fresh (never used) slot
+   *
+   * \param is_port Claim slot for a port?
+   * \return Index of claimed slot
+   */
+  tHandle ClaimFreshSlot(bool is_port);
+
+  /*!
+   * \param index Index of slot
+   * \return Array that contains slot with specified index (NULL if it has not been created yet)
+   */
+  tElementArray* GetElementArray(tHandle index)
+  {
+#ifdef FINROC_64_BIT_HANDLES
+    tSecondaryArray* secondary = array_chunks[index >> (definitions::cHANDLE_SECONDARY_ARRAY_INDEX_BIT_WIDTH + cELEMENT_ARRAY_INDEX_BIT_WIDTH)].load(std::memory_order_acquire);
+    return secondary ? secondary->array[(index >> cELEMENT_ARRAY_INDEX_BIT_WIDTH) & cSECONDARY_INDEX_MASK].load(std::memory_order_acquire) : NULL;
+#else
+    return array_chunks[index >> cELEMENT_ARRAY_INDEX_BIT_WIDTH].load(std::memory_order_acquire);
+#endif
+  }
+
+  /*!
+   * \param index Index of slot
+   * \return Array that contains slot with specified index (created - together with any intermediate arrays - if it does not exist yet)
+   */
+  tElementArray& GetOrCreateElementArray(tHandle index);
+
+  /*!
+   * Moves slots of all expired generations in pool to its reusable slots
+   * (mutex needs to be acquired)
+   *
+   * \param pool Pool to process
+   * \param now Current time
+   */
+  static void RecycleExpiredGenerations(tSlotPool& pool, rrlib::time::tTimestamp now);
+
+  /*!
+   * \param handle Handle of element
+   * \param element_index Contains index of element's slot in returned array after call
+   * \return Array that contains slot of element with specified handle (NULL if no element with this handle is registered)
+   */
+  tElementArray* GetElementSlot(tHandle handle, tHandle& element_index)
+  {
+    tHandle index = handle >> cSTAMP_BIT_WIDTH;
+    element_index = index & cELEMENT_INDEX_MASK;
+    tElementArray* chunk = GetElementArray(index);
+    return (chunk && chunk->array[element_index].load(std::memory_order_relaxed) && chunk->handles[element_index].load(std::memory_order_relaxed) == handle) ? chunk : NULL;
+  }
+
+  /*!
+   * Changes slot and assigns new structure version to it
+   * (only one thread may change a slot at a time)
+   *
+   * \param chunk Array that contains slot
+   * \param index Index of slot
+   * \param element New element in slot (NULL if element is removed)
+   * \param handle Handle of element (or of removed element)
+   */
+  void SetSlot(tElementArray& chunk, tHandle index, tFrameworkElement* element, tHandle handle);
+
+  /*!
+   * \param next_index Next index to claim (value of next_index or next_port_index)
+   * \param max_index Maximum valid index in this area
+   * \return Index of last slot that might be in use
+   */
+  static tHandle LastUsedIndex(tHandle next_index, tHandle max_index)
+  {
+    return std::min(next_index - 1, max_index);
+  }
 };
 
 //----------------------------------------------------------------------
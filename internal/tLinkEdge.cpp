@@ -38,6 +38,7 @@
 //----------------------------------------------------------------------
 #include "core/tRuntimeEnvironment.h"
 #include "core/port/tAbstractPort.h"
+#include "core/internal/tStructureLock.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -80,52 +81,116 @@ tLinkEdge::tLinkEdge(const tPortReference& port1, const tPortReference& port2, b
   ports(CreatePortReferenceArray(port1, port2)),
   both_connect_directions(both_connect_directions),
   next_edge(NULL),
-  finstructed(finstructed)
+  finstructed(finstructed),
+  created_connections()
 {
   if (ports[0].link.length() == 0 && ports[1].link.length() == 0)
   {
     FINROC_LOG_PRINT(ERROR, "At least one of two ports needs to be linked. Otherwise, it does not make sense to use this class.");
     abort();
   }
-  rrlib::thread::tLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex());
+  tStructureLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex(), "tLinkEdge::tLinkEdge");
   for (size_t i = 0; i < 2; i++)
   {
     if (ports[i].link.length() > 0)
     {
-      tRuntimeEnvironment::GetInstance().AddLinkEdge(ports[i].link, *this);
+      tRuntimeEnvironment::GetInstance().AddLinkEdge(&ports[i].link, *this);
     }
   }
 }
 
 tLinkEdge::~tLinkEdge()
 {
-  rrlib::thread::tLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex());
+  tStructureLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex(), "tLinkEdge::~tLinkEdge");
   for (size_t i = 0; i < 2; i++)
   {
     if (ports[i].link.length() > 0)
     {
-      tRuntimeEnvironment::GetInstance().RemoveLinkEdge(ports[i].link, *this);
+      tRuntimeEnvironment::GetInstance().RemoveLinkEdge(&ports[i].link, *this);
     }
+    tNamePool::Release(&ports[i].link);
   }
 }
 
-void tLinkEdge::LinkAdded(tRuntimeEnvironment& re, const tString& link, tAbstractPort& port) const
+void tLinkEdge::Connect(tAbstractPort& port, tAbstractPort& partner, size_t index) const
 {
-  rrlib::thread::tLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex());
-  if (link.compare(ports[0].link) == 0)
+  tAbstractPort::tConnectDirection direction = both_connect_directions ? tAbstractPort::tConnectDirection::AUTO :
+      (index == 0 ? tAbstractPort::tConnectDirection::TO_TARGET : tAbstractPort::tConnectDirection::TO_SOURCE);
+  const tAbstractPort* pointer = ports[0].pointer ? ports[0].pointer : ports[1].pointer;
+  if (!pointer)
+  {
+    port.ConnectTo(partner, direction, finstructed);
+    return;
+  }
+
+  bool connected_before = port.IsConnectedTo(partner);
+  port.ConnectTo(partner, direction, finstructed);
+  if ((!connected_before) && port.IsConnectedTo(partner))
+  {
+    // forget connections to ports that have been deleted (handles are not reused for other ports)
+    tRuntimeEnvironment& re = tRuntimeEnvironment::GetInstance();
+    for (size_t i = 0; i < created_connections.size(); i++)
+    {
+      if (!re.GetPort(created_connections[i]))
+      {
+        created_connections[i] = created_connections.back();
+        created_connections.pop_back();
+        i--;
+      }
+    }
+    created_connections.push_back((&port == pointer ? partner : port).GetHandle());
+  }
+}
+
+void tLinkEdge::DisconnectCreatedConnections(tRuntimeEnvironment& re) const
+{
+  tAbstractPort* pointer = ports[0].pointer ? ports[0].pointer : ports[1].pointer;
+  for (auto it = created_connections.begin(); pointer && it != created_connections.end(); ++it)
+  {
+    tAbstractPort* partner = re.GetPort(*it);
+    if (partner && pointer->IsConnectedTo(*partner))
+    {
+      pointer->DisconnectFrom(*partner);
+    }
+  }
+  created_connections.clear();
+}
+
+void tLinkEdge::LinkAdded(tRuntimeEnvironment& re, tNamePool::tAtom link, tAbstractPort& port) const
+{
+  tStructureLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex(), "tLinkEdge::LinkAdded");
+  if (link == &ports[0].link)
   {
     tAbstractPort* target = ports[1].link.length() > 0 ? re.GetPort(ports[1].link) : ports[1].pointer;
     if (target)
     {
-      port.ConnectTo(*target, both_connect_directions ? tAbstractPort::tConnectDirection::AUTO : tAbstractPort::tConnectDirection::TO_TARGET, finstructed);
+      Connect(port, *target, 0);
     }
   }
-  else if (link.compare(ports[1].link) == 0)
+  else if (link == &ports[1].link)
   {
     tAbstractPort* source = ports[0].link.length() > 0 ? re.GetPort(ports[0].link) : ports[0].pointer;
     if (source)
     {
-      port.ConnectTo(*source, both_connect_directions ? tAbstractPort::tConnectDirection::AUTO : tAbstractPort::tConnectDirection::TO_SOURCE, finstructed);
+      Connect(port, *source, 1);
+    }
+  }
+}
+
+void tLinkEdge::PortAdded(tRuntimeEnvironment& re) const
+{
+  tStructureLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex(), "tLinkEdge::PortAdded");
+  for (size_t i = 0; i < 2; i++)
+  {
+    if (ports[i].pointer)
+    {
+      const tPortReference& other = ports[1 - i];
+      tAbstractPort* other_port = other.pointer ? other.pointer : re.GetPort(other.link);
+      if (other_port)
+      {
+        Connect(*ports[i].pointer, *other_port, i);
+      }
+      return;
     }
   }
 }
@@ -41,12 +41,14 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include <array>
+#include <vector>
 #include "rrlib/util/tNoncopyable.h"
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "core/definitions.h"
+#include "core/internal/tNamePool.h"
 
 //----------------------------------------------------------------------
 // Namespace declaration
@@ -83,16 +85,18 @@ public:
 
   /*!
    * Reference to a port - either link or pointer
+   * (links are interned - so they can be compared by address;
+   *  the reference to the interned link is released by the link edge that port reference is passed to)
    */
   class tPortReference
   {
     friend class tLinkEdge;
 
-    const tString link;
+    const tString& link;
     tAbstractPort* const pointer;
   public:
-    tPortReference(const tString& link) : link(link), pointer(NULL) {}
-    tPortReference(tAbstractPort& port) : link(""), pointer(&port) {}
+    tPortReference(const tString& link) : link(tNamePool::Intern(link)), pointer(NULL) {}
+    tPortReference(tAbstractPort& port) : link(tNamePool::Intern(tString())), pointer(&port) {}
   };
 
   /*!
@@ -110,7 +114,7 @@ public:
   /*!
    * \return Link of first port - possibly empty if a port was provided directly instead
    */
-  inline tString GetSourceLink() const
+  inline const tString& GetSourceLink() const
   {
     return ports[0].link;
   }
@@ -118,7 +122,7 @@ public:
   /*!
    * \return Link of second port - possibly empty if a port was provided directly instead
    */
-  inline tString GetTargetLink() const
+  inline const tString& GetTargetLink() const
   {
     return ports[1].link;
   }
@@ -137,6 +141,7 @@ public:
 private:
 
   friend class finroc::core::tRuntimeEnvironment;
+  friend class finroc::core::tAbstractPort;
 
   /*!
    * Ports that edge operates on.
@@ -156,6 +161,29 @@ private:
   /*! Is this a finstructed link edge? */
   const bool finstructed;
 
+  /*!
+   * Handles of ports that this edge has connected to the port referenced by pointer
+   * (only recorded for edges that reference a port by pointer - so that DisconnectCreatedConnections() does not remove connections created otherwise)
+   */
+  mutable std::vector<definitions::tHandle> created_connections;
+
+  /*!
+   * Connects two ports - and records connection if this edge created it
+   *
+   * \param port Port to call ConnectTo() on
+   * \param partner Port to connect to
+   * \param index Index of 'port' in 'ports' (determines connect direction)
+   */
+  void Connect(tAbstractPort& port, tAbstractPort& partner, size_t index) const;
+
+  /*!
+   * Removes all connections that this edge has created and that still exist
+   * (must only be called with lock on runtime-registry)
+   *
+   * \param re RuntimeEnvironment
+   */
+  void DisconnectCreatedConnections(tRuntimeEnvironment& re) const;
+
   /*!
    * \return Pointer to next edge - for a singly linked list
    */
@@ -177,10 +205,19 @@ private:
    * (must only be called with lock on runtime-registry)
    *
    * \param re RuntimeEnvironment
-   * \param link Link that has been added
+   * \param link Atom of link that has been added
    * \param port port linked to
    */
-  void LinkAdded(tRuntimeEnvironment& re, const tString& link, tAbstractPort& port) const;
+  void LinkAdded(tRuntimeEnvironment& re, tNamePool::tAtom link, tAbstractPort& port) const;
+
+  /*!
+   * Called by RuntimeEnvironment when port that this edge references by pointer has been published.
+   * Connects it to the port at the other end - if that port exists already.
+   * (must only be called with lock on runtime-registry)
+   *
+   * \param re RuntimeEnvironment
+   */
+  void PortAdded(tRuntimeEnvironment& re) const;
 
 };
 
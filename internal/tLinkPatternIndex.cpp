@@ -0,0 +1,275 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tLinkPatternIndex.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/internal/tLinkPatternIndex.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+tLinkPatternIndex::tLinkPatternIndex() :
+  pattern_pairs(),
+  root(),
+  captures(),
+  element_buffer()
+{}
+
+tLinkPatternIndex::~tLinkPatternIndex()
+{}
+
+bool tLinkPatternIndex::Add(const tString& source_pattern, const tString& target_pattern, bool both_connect_directions)
+{
+  if (GetWildcardCount(source_pattern) != GetWildcardCount(target_pattern))
+  {
+    return false;
+  }
+  if (Find(source_pattern, target_pattern))
+  {
+    return false;
+  }
+
+  tPatternPair* pair = new tPatternPair();
+  pair->patterns[0] = source_pattern;
+  pair->patterns[1] = target_pattern;
+  pair->both_connect_directions = both_connect_directions;
+  pattern_pairs.emplace_back(pair);
+
+  // Insert both patterns into prefix tree
+  for (size_t i = 0; i < 2; i++)
+  {
+    GetNode(pair->patterns[i]).patterns.push_back(std::make_pair(pair, i));
+  }
+  return true;
+}
+
+const tLinkPatternIndex::tPatternPair* tLinkPatternIndex::Find(const tString& source_pattern, const tString& target_pattern) const
+{
+  for (auto it = pattern_pairs.begin(); it != pattern_pairs.end(); ++it)
+  {
+    if ((*it)->patterns[0] == source_pattern && (*it)->patterns[1] == target_pattern)
+    {
+      return it->get();
+    }
+  }
+  return NULL;
+}
+
+void tLinkPatternIndex::FindMatches(const tString& link, std::vector<tMatch>& result, const tPatternPair* pattern_pair)
+{
+  tNode* node = &root;
+  size_t element_start = (link.length() > 0 && link[0] == '/') ? 1 : 0;
+  while (node)
+  {
+    for (auto it = node->patterns.begin(); it != node->patterns.end(); ++it)
+    {
+      const tPatternPair& pair = *it->first;
+      if (pattern_pair && pattern_pair != &pair)
+      {
+        continue;
+      }
+      const tString& pattern = pair.patterns[it->second];
+      captures.clear();
+      if (!Match(pattern, 0, link, 0))
+      {
+        continue;
+      }
+
+      // create link for other end by replacing its wildcards
+      const tString& other_pattern = pair.patterns[1 - it->second];
+      tMatch match;
+      match.both_connect_directions = pair.both_connect_directions;
+      match.pattern_pair = &pair;
+      match.link_is_source = it->second == 0;
+      tString& other_link = it->second == 0 ? match.target_link : match.source_link;
+      (it->second == 0 ? match.source_link : match.target_link) = link;
+      size_t capture_index = 0;
+      for (size_t i = 0; i < other_pattern.length(); i++)
+      {
+        if (other_pattern[i] == '*')
+        {
+          other_link.append(link, captures[capture_index].first, captures[capture_index].second);
+          capture_index++;
+        }
+        else
+        {
+          other_link += other_pattern[i];
+        }
+      }
+      result.push_back(match);
+    }
+
+    // descend into prefix tree
+    size_t element_end = link.find('/', element_start);
+    if (element_end == tString::npos)
+    {
+      break;
+    }
+    element_buffer.assign(link, element_start, element_end - element_start);
+    auto child = node->children.find(element_buffer);
+    node = child != node->children.end() ? child->second.get() : NULL;
+    element_start = element_end + 1;
+  }
+}
+
+tLinkPatternIndex::tNode& tLinkPatternIndex::GetNode(const tString& pattern)
+{
+  tNode* node = &root;
+  size_t element_start = (pattern.length() > 0 && pattern[0] == '/') ? 1 : 0;
+  while (true)
+  {
+    size_t element_end = std::min(pattern.find('/', element_start), pattern.length());
+    if (element_end == pattern.length() || pattern.find('*', element_start) < element_end)
+    {
+      break;   // last path element or path element with wildcard
+    }
+    std::unique_ptr<tNode>& child = node->children[pattern.substr(element_start, element_end - element_start)];
+    if (!child)
+    {
+      child.reset(new tNode());
+    }
+    node = child.get();
+    element_start = element_end + 1;
+  }
+  return *node;
+}
+
+size_t tLinkPatternIndex::GetWildcardCount(const tString& pattern)
+{
+  return std::count(pattern.begin(), pattern.end(), '*');
+}
+
+bool tLinkPatternIndex::Match(const tString& pattern, size_t pattern_index, const tString& link, size_t link_index)
+{
+  while (pattern_index < pattern.length())
+  {
+    if (pattern[pattern_index] == '*')
+    {
+      // try shortest matches first - wildcards do not match '/'
+      for (size_t end = link_index; ; end++)
+      {
+        captures.push_back(std::make_pair(link_index, end - link_index));
+        if (Match(pattern, pattern_index + 1, link, end))
+        {
+          return true;
+        }
+        captures.pop_back();
+        if (end >= link.length() || link[end] == '/')
+        {
+          return false;
+        }
+      }
+    }
+    if (link_index >= link.length() || pattern[pattern_index] != link[link_index])
+    {
+      return false;
+    }
+    pattern_index++;
+    link_index++;
+  }
+  return link_index == link.length();
+}
+
+void tLinkPatternIndex::Remove(const tPatternPair& pattern_pair)
+{
+  for (size_t i = 0; i < 2; i++)
+  {
+    const tString& pattern = pattern_pair.patterns[i];
+    RemovePattern(root, pattern, (pattern.length() > 0 && pattern[0] == '/') ? 1 : 0, std::make_pair(&pattern_pair, i));
+  }
+  for (auto it = pattern_pairs.begin(); it != pattern_pairs.end(); ++it)
+  {
+    if (it->get() == &pattern_pair)
+    {
+      pattern_pairs.erase(it);
+      return;
+    }
+  }
+}
+
+bool tLinkPatternIndex::RemovePattern(tNode& node, const tString& pattern, size_t element_start, const std::pair<const tPatternPair*, size_t>& entry)
+{
+  size_t element_end = std::min(pattern.find('/', element_start), pattern.length());
+  if (element_end == pattern.length() || pattern.find('*', element_start) < element_end)
+  {
+    node.patterns.erase(std::remove(node.patterns.begin(), node.patterns.end(), entry), node.patterns.end());  // pattern is stored in this node (see GetNode())
+  }
+  else
+  {
+    auto child = node.children.find(pattern.substr(element_start, element_end - element_start));
+    assert(child != node.children.end());
+    if (RemovePattern(*child->second, pattern, element_end + 1, entry))
+    {
+      node.children.erase(child);
+    }
+  }
+  return node.patterns.empty() && node.children.empty();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
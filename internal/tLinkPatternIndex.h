@@ -0,0 +1,233 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tLinkPatternIndex.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tLinkPatternIndex
+ *
+ * \b tLinkPatternIndex
+ *
+ * Index of link pattern pairs that connect ports with matching links as they are published.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__internal__tLinkPatternIndex_h__
+#define __core__internal__tLinkPatternIndex_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/definitions.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Index of link patterns
+/*!
+ * Stores pairs of link patterns - each pattern referring to one end of a connection.
+ * A '*' in a pattern matches any sequence of characters within one path element (excluding '/').
+ * Both patterns of a pair contain the same number of wildcards:
+ * When a link matches one pattern, the link at the other end is obtained by
+ * replacing the wildcards in the other pattern with the matched strings (in order).
+ *
+ * Patterns are stored in a prefix tree of the path elements before their first wildcard.
+ * So, only patterns whose literal prefix matches a link are tested against it.
+ * (may only be accessed in runtime-registry-synchronized context)
+ */
+class tLinkPatternIndex : private rrlib::util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Pair of link patterns */
+  struct tPatternPair
+  {
+    /*! Patterns for links of source and target ports */
+    tString patterns[2];
+
+    /*! Should the two ports be connected in any direction? */
+    bool both_connect_directions;
+  };
+
+  /*! Connection resulting from link that matched a pattern */
+  struct tMatch
+  {
+    /*! Link of source port */
+    tString source_link;
+
+    /*! Link of target port */
+    tString target_link;
+
+    /*! Should the two ports be connected in any direction? (otherwise only from source to target) */
+    bool both_connect_directions;
+
+    /*! Pattern pair that link matched */
+    const tPatternPair* pattern_pair;
+
+    /*! Did link match the source pattern? (otherwise it matched the target pattern) */
+    bool link_is_source;
+  };
+
+  tLinkPatternIndex();
+
+  ~tLinkPatternIndex();
+
+  /*!
+   * Adds pattern pair to index
+   *
+   * \param source_pattern Pattern for links of source ports
+   * \param target_pattern Pattern for links of target ports
+   * \param both_connect_directions Should the two ports be connected in any direction? (otherwise only from source to target)
+   * \return False, if pair is invalid (wildcard counts differ) or has already been added
+   */
+  bool Add(const tString& source_pattern, const tString& target_pattern, bool both_connect_directions);
+
+  /*!
+   * \return Does index contain no patterns?
+   */
+  bool Empty() const
+  {
+    return pattern_pairs.empty();
+  }
+
+  /*!
+   * \param source_pattern Pattern for links of source ports
+   * \param target_pattern Pattern for links of target ports
+   * \return Pattern pair with these patterns - or NULL if no such pair has been added
+   */
+  const tPatternPair* Find(const tString& source_pattern, const tString& target_pattern) const;
+
+  /*!
+   * Finds all patterns that specified link matches
+   *
+   * \param link Absolute link (e.g. qualified link of port)
+   * \param result Vector to append connections resulting from matching patterns to
+   * \param pattern_pair If not NULL, only this pattern pair is checked
+   */
+  void FindMatches(const tString& link, std::vector<tMatch>& result, const tPatternPair* pattern_pair = NULL);
+
+  /*!
+   * \param pattern Link pattern
+   * \return Number of wildcards in pattern
+   */
+  static size_t GetWildcardCount(const tString& pattern);
+
+  /*!
+   * Removes pattern pair from index
+   *
+   * \param pattern_pair Pattern pair to remove (obtained via Find(); deleted by this call)
+   */
+  void Remove(const tPatternPair& pattern_pair);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Node in prefix tree */
+  struct tNode
+  {
+    /*! Child nodes by path element */
+    std::map<tString, std::unique_ptr<tNode>> children;
+
+    /*! Patterns whose literal prefix ends at this node (pattern pair and index of pattern in pair) */
+    std::vector<std::pair<const tPatternPair*, size_t>> patterns;
+  };
+
+  /*! All pattern pairs in index */
+  std::vector<std::unique_ptr<tPatternPair>> pattern_pairs;
+
+  /*! Root of prefix tree */
+  tNode root;
+
+  /*! Start indices and lengths of substrings matching wildcards (buffer) */
+  std::vector<std::pair<size_t, size_t>> captures;
+
+  /*! Temporary buffer for path elements */
+  tString element_buffer;
+
+  /*!
+   * \param pattern Pattern
+   * \return Node in prefix tree that pattern is stored in (path elements before first wildcard - created if it does not exist yet)
+   */
+  tNode& GetNode(const tString& pattern);
+
+  /*!
+   * Matches link against pattern - starting at the specified positions
+   *
+   * \param pattern Pattern
+   * \param pattern_index Current position in pattern
+   * \param link Link
+   * \param link_index Current position in link
+   * \return True, if rest of link matches rest of pattern (substrings matching wildcards are appended to 'captures')
+   */
+  bool Match(const tString& pattern, size_t pattern_index, const tString& link, size_t link_index);
+
+  /*!
+   * Removes pattern from subtree - and deletes nodes of subtree that become empty
+   *
+   * \param node Root of subtree
+   * \param pattern Pattern
+   * \param element_start Position of path element in pattern that corresponds to node's children
+   * \param entry Entry of pattern in node (pattern pair and index of pattern in pair)
+   * \return True, if node contains no patterns and has no children afterwards (so that parent may delete it)
+   */
+  bool RemovePattern(tNode& node, const tString& pattern, size_t element_start, const std::pair<const tPatternPair*, size_t>& entry);
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
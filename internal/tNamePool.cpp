@@ -0,0 +1,197 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tNamePool.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/internal/tNamePool.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/thread/tLock.h"
+#include <array>
+#include <unordered_map>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tLockOrderLevel.h"
+#include "core/internal/tGarbageDeleter.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+namespace
+{
+
+/*! Hashes interned strings by value */
+struct tNameHash
+{
+  size_t operator()(const tString* name) const
+  {
+    return std::hash<tString>()(*name);
+  }
+};
+
+/*! Compares interned strings by value */
+struct tNameEqual
+{
+  bool operator()(const tString* name1, const tString* name2) const
+  {
+    return *name1 == *name2;
+  }
+};
+
+/*! Shard of pool */
+struct tShard
+{
+  /*! Mutex for shard (innermost lock - no other locks are acquired while holding it) */
+  rrlib::thread::tOrderedMutex mutex;
+
+  /*! Interned names (allocated on heap - so addresses are stable) with their reference counts */
+  std::unordered_map<const tString*, size_t, tNameHash, tNameEqual> names;
+
+  tShard() :
+    mutex("Name Pool", static_cast<int>(tLockOrderLevel::INNER_MOST)),
+    names()
+  {}
+};
+
+/*! Number of shards (power of two) */
+enum { cSHARD_COUNT = 16 };
+
+/*! Pool data */
+struct tPool
+{
+  std::array<tShard, cSHARD_COUNT> shards;
+};
+
+/*!
+ * \return Pool (created on first use - so names may also be interned during static initialization;
+ *          never deleted - so names may also be released during static destruction)
+ */
+tPool& GetPool()
+{
+  static tPool* pool = new tPool();
+  return *pool;
+}
+
+/*!
+ * \param name Name
+ * \return Shard responsible for name
+ */
+tShard& GetShard(const tString& name)
+{
+  return GetPool().shards[std::hash<tString>()(name) & (cSHARD_COUNT - 1)];
+}
+
+}
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+tNamePool::tAtom tNamePool::Find(const tString& name)
+{
+  tShard& shard = GetShard(name);
+  rrlib::thread::tLock lock(shard.mutex);
+  auto it = shard.names.find(&name);
+  return it != shard.names.end() ? it->first : NULL;
+}
+
+const tString& tNamePool::Intern(const tString& name)
+{
+  tShard& shard = GetShard(name);
+  rrlib::thread::tLock lock(shard.mutex);
+  auto it = shard.names.find(&name);
+  if (it == shard.names.end())
+  {
+    it = shard.names.insert(std::make_pair(new tString(name), 0)).first;
+  }
+  it->second++;
+  return *it->first;
+}
+
+void tNamePool::Release(tAtom atom)
+{
+  tShard& shard = GetShard(*atom);
+  {
+    rrlib::thread::tLock lock(shard.mutex);
+    auto it = shard.names.find(atom);
+    assert(it != shard.names.end() && it->first == atom && it->second > 0);
+    it->second--;
+    if (it->second > 0)
+    {
+      return;
+    }
+    shard.names.erase(it);
+  }
+  tGarbageDeleter::DeleteDeferred(const_cast<tString*>(atom));  // outside of innermost lock
+}
+
+size_t tNamePool::Size()
+{
+  size_t result = 0;
+  tPool& pool = GetPool();
+  for (auto it = pool.shards.begin(); it != pool.shards.end(); ++it)
+  {
+    rrlib::thread::tLock lock(it->mutex);
+    result += it->names.size();
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,128 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tNamePool.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tNamePool
+ *
+ * \b tNamePool
+ *
+ * Process-wide pool of interned framework element names and links.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__internal__tNamePool_h__
+#define __core__internal__tNamePool_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/definitions.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Pool of interned names
+/*!
+ * Process-wide pool of interned framework element names and links.
+ *
+ * Every distinct name is stored exactly once - so e.g. thousands of ports named "Input"
+ * share one string. Interned strings are never modified.
+ * Their address is the name's atom: two interned names are equal if and only if
+ * their addresses are equal.
+ *
+ * Interned strings are reference counted: Every Intern() call must be matched by a call to Release().
+ * When the last reference is released, the string is removed from the pool and deleted via the garbage deleter
+ * (so that lock-free readers still using it are safe).
+ *
+ * The pool is split into shards by hash value - with an innermost lock each - so that threads creating elements concurrently rarely contend.
+ * All methods are thread-safe.
+ */
+class tNamePool
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Atom identifying an interned name (address of interned string) */
+  typedef const tString* tAtom;
+
+  /*!
+   * \param name Name to look for
+   * \return Atom of name - or NULL if name has not been interned (in this case, no framework element has this name)
+   * (does not acquire a reference - so atom may only be used for lookups while name is known to be referenced)
+   */
+  static tAtom Find(const tString& name);
+
+  /*!
+   * Interns name and acquires a reference to the interned string
+   *
+   * \param name Name to intern
+   * \return Interned string equal to 'name' (reference remains valid until it is released with Release())
+   */
+  static const tString& Intern(const tString& name);
+
+  /*!
+   * Releases reference acquired with Intern()
+   *
+   * \param atom Atom of interned string
+   */
+  static void Release(tAtom atom);
+
+  /*!
+   * \return Number of distinct names that have been interned
+   */
+  static size_t Size();
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,278 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tPortLinkIndex.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/internal/tPortLinkIndex.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/port/tAbstractPort.h"
+#include "core/internal/tGarbageDeleter.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+/*! Initial number of buckets in lookup tables */
+const size_t cINITIAL_BUCKET_COUNT = 64;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+namespace
+{
+
+/*!
+ * FNV-1a hash of link
+ * (can be calculated for a link with a slash prepended - without constructing this string)
+ *
+ * \param link Link
+ * \param prepend_slash Whether to calculate hash of link with a slash prepended
+ * \return Hash
+ */
+size_t HashLink(const tString& link, bool prepend_slash)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  if (prepend_slash)
+  {
+    hash = (hash ^ static_cast<unsigned char>('/')) * 1099511628211ULL;
+  }
+  for (size_t i = 0; i < link.length(); i++)
+  {
+    hash = (hash ^ static_cast<unsigned char>(link[i])) * 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+/*!
+ * \param key Key of entry in lookup table
+ * \param link Link to compare with
+ * \param prepend_slash Whether to compare with link with a slash prepended
+ * \return True if key equals link
+ */
+bool LinkEquals(const tString& key, const tString& link, bool prepend_slash)
+{
+  if (prepend_slash)
+  {
+    return key.length() == link.length() + 1 && key[0] == '/' && key.compare(1, link.length(), link) == 0;
+  }
+  return key == link;
+}
+
+}
+
+tPortLinkIndex::tNode::tNode(const tString& link, size_t hash, tAbstractPort& port, tNode* next) :
+  link(&link),
+  hash(hash),
+  port(&port),
+  next(next)
+{}
+
+tPortLinkIndex::tBuckets::tBuckets(size_t size) :
+  size(size),
+  first(new std::atomic<tNode*>[size])
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    first[i].store(NULL, std::memory_order_relaxed);
+  }
+}
+
+tPortLinkIndex::tBuckets::~tBuckets()
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    tNode* node = first[i].load(std::memory_order_relaxed);
+    while (node)
+    {
+      tNode* next = node->next.load(std::memory_order_relaxed);
+      delete node;
+      node = next;
+    }
+  }
+}
+
+tPortLinkIndex::tTable::tTable() :
+  buckets(new tBuckets(cINITIAL_BUCKET_COUNT)),
+  entry_count(0)
+{}
+
+tPortLinkIndex::tTable::~tTable()
+{
+  delete buckets.load();
+}
+
+bool tPortLinkIndex::tTable::Add(const tString& link, tAbstractPort& port)
+{
+  if (Find(link, false))
+  {
+    return false;
+  }
+
+  tBuckets* current = buckets.load(std::memory_order_relaxed);
+  if (entry_count >= current->size)
+  {
+    // grow: readers might still traverse the current buckets - so entries are copied to a new bucket array and the current one is deleted deferred
+    tBuckets* grown = new tBuckets(current->size * 2);
+    for (size_t i = 0; i < current->size; i++)
+    {
+      for (tNode* node = current->first[i].load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed))
+      {
+        std::atomic<tNode*>& bucket = grown->first[node->hash & (grown->size - 1)];
+        bucket.store(new tNode(*node->link, node->hash, *node->port, bucket.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+      }
+    }
+    buckets.store(grown, std::memory_order_release);
+    tGarbageDeleter::DeleteDeferred(current);
+    current = grown;
+  }
+
+  size_t hash = HashLink(link, false);
+  std::atomic<tNode*>& bucket = current->first[hash & (current->size - 1)];
+  bucket.store(new tNode(link, hash, port, bucket.load(std::memory_order_relaxed)), std::memory_order_release);
+  entry_count++;
+  return true;
+}
+
+tAbstractPort* tPortLinkIndex::tTable::Find(const tString& link, bool prepend_slash) const
+{
+  size_t hash = HashLink(link, prepend_slash);
+  tBuckets* current = buckets.load(std::memory_order_acquire);
+  for (tNode* node = current->first[hash & (current->size - 1)].load(std::memory_order_acquire); node; node = node->next.load(std::memory_order_acquire))
+  {
+    if (node->hash == hash && LinkEquals(*node->link, link, prepend_slash))
+    {
+      return node->port;
+    }
+  }
+  return NULL;
+}
+
+void tPortLinkIndex::tTable::Remove(const tString& link, tAbstractPort& port)
+{
+  tBuckets* current = buckets.load(std::memory_order_relaxed);
+  std::atomic<tNode*>* predecessor_next = &current->first[HashLink(link, false) & (current->size - 1)];
+  for (tNode* node = predecessor_next->load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed))
+  {
+    if (node->link == &link && node->port == &port)
+    {
+      predecessor_next->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);  // concurrent readers on node can still continue with its successors
+      tGarbageDeleter::DeleteDeferred(node);
+      entry_count--;
+      return;
+    }
+    predecessor_next = &node->next;
+  }
+  assert(false && "Entry not in table");
+}
+
+tPortLinkIndex::tPortLinkIndex() :
+  full_links(),
+  globally_unique_links(),
+  entries()
+{}
+
+void tPortLinkIndex::Add(tAbstractPort& port)
+{
+  for (size_t i = 0; i < port.GetLinkCount(); i++)
+  {
+    const tString& name = port.GetQualifiedNameReference(i);
+    const tString& link = port.GetQualifiedLinkReference(i);
+    AddEntry(full_links, name, port);
+    if (&link != &name && link != name)
+    {
+      AddEntry(globally_unique_links, link, port);
+    }
+  }
+}
+
+void tPortLinkIndex::AddEntry(tTable& table, const tString& link, tAbstractPort& port)
+{
+  if (table.Add(link, port))
+  {
+    tEntry entry = { &table, &link };
+    entries.insert(std::make_pair(&port, entry));
+  }
+  else
+  {
+    FINROC_LOG_PRINT(DEBUG_WARNING, "Port with link '", link, "' already exists. Lookups by this link will return the other port.");
+  }
+}
+
+tAbstractPort* tPortLinkIndex::Find(const tString& link) const
+{
+  bool prepend_slash = link.length() > 0 && link[0] != '/';
+  tAbstractPort* result = full_links.Find(link, prepend_slash);
+  return result ? result : globally_unique_links.Find(link, prepend_slash);
+}
+
+void tPortLinkIndex::Remove(tAbstractPort& port)
+{
+  auto range = entries.equal_range(&port);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    it->second.table->Remove(*it->second.link, port);
+  }
+  entries.erase(range.first, range.second);
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,240 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tPortLinkIndex.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tPortLinkIndex
+ *
+ * \b tPortLinkIndex
+ *
+ * Index of all published ports by their qualified links.
+ * Used by the runtime environment to look up ports by link
+ * without walking the framework element tree.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__internal__tPortLinkIndex_h__
+#define __core__internal__tPortLinkIndex_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/definitions.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+class tAbstractPort;
+
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Index of ports by qualified link
+/*!
+ * Index of all published ports by their qualified links.
+ * Used by the runtime environment to look up ports by link
+ * without walking the framework element tree.
+ *
+ * Contains two entries for every link of a port:
+ * its full qualified link (from the runtime root) and - if the link contains an element
+ * with a globally unique link - its link relative to the alternative link root
+ * (e.g. the remote runtime environment the port belongs to).
+ * Full links take precedence when looking up ports (as in tree-based lookup).
+ *
+ * Links of published elements do not change.
+ * Therefore, ports are added when they are published and removed when they are deleted.
+ * Add() and Remove() may only be called in runtime-registry-synchronized context.
+ * Find() may be called without any lock: the lookup tables are hash tables with atomic bucket chains.
+ * Removed entries - and bucket arrays replaced when a table grows - are deleted by the tGarbageDeleter.
+ */
+class tPortLinkIndex : private rrlib::util::tNoncopyable
+{
+  /*! Entry in lookup table */
+  struct tNode
+  {
+    /*! Key: link of port (points to port's cached qualified names - so no strings are copied when ports are added) */
+    const tString* link;
+
+    /*! Hash of link */
+    size_t hash;
+
+    /*! Port with this link */
+    tAbstractPort* port;
+
+    /*! Next entry in same bucket */
+    std::atomic<tNode*> next;
+
+    tNode(const tString& link, size_t hash, tAbstractPort& port, tNode* next);
+  };
+
+  /*! Bucket array of lookup table (replaced by a larger copy when table grows) */
+  struct tBuckets : private rrlib::util::tNoncopyable
+  {
+    /*! Number of buckets (power of two) */
+    const size_t size;
+
+    /*! First entry in every bucket */
+    std::unique_ptr<std::atomic<tNode*>[]> first;
+
+    tBuckets(size_t size);
+
+    /*! Deletes all entries in buckets */
+    ~tBuckets();
+  };
+
+  /*! Lookup table */
+  class tTable : private rrlib::util::tNoncopyable
+  {
+  public:
+
+    tTable();
+
+    ~tTable();
+
+    /*!
+     * Adds entry to table - unless table already contains an entry with this link
+     *
+     * \param link Qualified link (must remain valid as long as port is in index)
+     * \param port Port
+     * \return True if entry was added
+     */
+    bool Add(const tString& link, tAbstractPort& port);
+
+    /*!
+     * \param link Link (with leading slash - unless 'prepend_slash' is set)
+     * \param prepend_slash Whether to prepend a slash to link
+     * \return Port with this link in table - or NULL if there is no such port
+     */
+    tAbstractPort* Find(const tString& link, bool prepend_slash) const;
+
+    /*!
+     * Removes entry from table
+     *
+     * \param link Qualified link that entry was added with (same object)
+     * \param port Port
+     */
+    void Remove(const tString& link, tAbstractPort& port);
+
+  private:
+
+    /*! Current bucket array */
+    std::atomic<tBuckets*> buckets;
+
+    /*! Number of entries in table */
+    size_t entry_count;
+  };
+
+  /*! Entry in index (used to remove port from index) */
+  struct tEntry
+  {
+    /*! Table that contains entry */
+    tTable* table;
+
+    /*! Key of entry (cached qualified link of port) */
+    const tString* link;
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  tPortLinkIndex();
+
+  /*!
+   * Adds all links of port to index
+   *
+   * \param port Port to add (must be ready and published)
+   */
+  void Add(tAbstractPort& port);
+
+  /*!
+   * (may be called without any lock)
+   *
+   * \param link (relative) Qualified link of port (a leading slash is optional)
+   * \return Port with this link - or NULL if no published port has this link
+   */
+  tAbstractPort* Find(const tString& link) const;
+
+  /*!
+   * Removes all links of port from index
+   * (does nothing if port has not been added)
+   *
+   * \param port Port to remove
+   */
+  void Remove(tAbstractPort& port);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Ports by full qualified link */
+  tTable full_links;
+
+  /*! Ports by link relative to alternative link root (links containing elements with globally unique links only) */
+  tTable globally_unique_links;
+
+  /*! Entries of every port in the above tables */
+  std::unordered_multimap<const tAbstractPort*, tEntry> entries;
+
+  /*!
+   * Adds entry to table
+   *
+   * \param table Table to add entry to
+   * \param link Qualified link (must remain valid as long as port is in index)
+   * \param port Port
+   */
+  void AddEntry(tTable& table, const tString& link, tAbstractPort& port);
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
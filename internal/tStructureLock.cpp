@@ -0,0 +1,173 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tStructureLock.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/internal/tStructureLock.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tRuntimeEnvironment.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+namespace
+{
+
+/*! Recorded data (may only be accessed with structure mutex acquired) */
+struct tProfile
+{
+  /*! Statistics per call site (keyed by call site name - equal string literals need not have the same address) */
+  std::unordered_map<std::string, tStructureLock::tCallSiteStatistics> call_sites;
+
+  /*! Call site pointers looked up so far (avoids constructing strings on every acquisition) */
+  std::unordered_map<const char*, tStructureLock::tCallSiteStatistics*> call_site_pointers;
+
+  /*! Statistics of call site that acquired the outermost structure lock */
+  tStructureLock::tCallSiteStatistics* current_call_site;
+
+  /*! Number of nested structure locks currently held (by the thread holding the structure mutex) */
+  size_t hold_depth;
+
+  /*! Time when outermost structure lock was acquired */
+  std::chrono::steady_clock::time_point acquire_time;
+
+  tProfile() :
+    call_sites(),
+    call_site_pointers(),
+    current_call_site(NULL),
+    hold_depth(0),
+    acquire_time()
+  {}
+};
+
+/*!
+ * \return Recorded data (constructed on first use, as locks might be acquired during static initialization)
+ */
+tProfile& GetProfile()
+{
+  static tProfile profile;
+  return profile;
+}
+
+/*! Sorts call sites by cumulative hold time (descending) */
+bool CompareHoldTime(const tStructureLock::tCallSiteStatistics& a, const tStructureLock::tCallSiteStatistics& b)
+{
+  return a.total_hold_time > b.total_hold_time;
+}
+
+}
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+std::vector<tStructureLock::tCallSiteStatistics> tStructureLock::GetStatistics()
+{
+  std::vector<tCallSiteStatistics> result;
+  rrlib::thread::tLock lock(tRuntimeEnvironment::GetInstance().GetStructureMutex());
+  tProfile& profile = GetProfile();
+  for (auto it = profile.call_sites.begin(); it != profile.call_sites.end(); ++it)
+  {
+    result.push_back(it->second);
+  }
+  std::sort(result.begin(), result.end(), CompareHoldTime);
+  return result;
+}
+
+void tStructureLock::OnAcquire()
+{
+  tProfile& profile = GetProfile();
+  profile.hold_depth++;
+  if (profile.hold_depth == 1)
+  {
+    profile.acquire_time = tClock::now();
+    auto it = profile.call_site_pointers.find(call_site);
+    if (it == profile.call_site_pointers.end())
+    {
+      tCallSiteStatistics& statistics = profile.call_sites.insert(std::make_pair(std::string(call_site), tCallSiteStatistics(call_site))).first->second;
+      it = profile.call_site_pointers.insert(std::make_pair(call_site, &statistics)).first;
+    }
+    profile.current_call_site = it->second;
+    profile.current_call_site->acquisitions++;
+    profile.current_call_site->total_wait_time += std::chrono::duration_cast<std::chrono::nanoseconds>(profile.acquire_time - wait_start);
+  }
+}
+
+void tStructureLock::OnRelease()
+{
+  tProfile& profile = GetProfile();
+  assert(profile.hold_depth > 0);
+  profile.hold_depth--;
+  if (profile.hold_depth == 0)
+  {
+    std::chrono::nanoseconds hold_time = std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - profile.acquire_time);
+    tCallSiteStatistics& statistics = *profile.current_call_site;
+    statistics.total_hold_time += hold_time;
+    statistics.max_hold_time = std::max(statistics.max_hold_time, hold_time);
+  }
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,179 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/internal/tStructureLock.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tStructureLock
+ *
+ * \b tStructureLock
+ *
+ * Lock on the runtime's structure mutex that records contention and
+ * hold time statistics per call site (if definitions::cPROFILE_STRUCTURE_LOCK is set).
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__internal__tStructureLock_h__
+#define __core__internal__tStructureLock_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/thread/tLock.h"
+#include "rrlib/util/tNoncopyable.h"
+#include <chrono>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/definitions.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Lock on structure mutex
+/*!
+ * Lock on the runtime's structure mutex that records contention and
+ * hold time statistics per call site (if definitions::cPROFILE_STRUCTURE_LOCK is set).
+ * Otherwise, it is equivalent to rrlib::thread::tLock.
+ *
+ * Statistics are recorded while the structure mutex is held - so recording
+ * requires no additional synchronization.
+ * Hold times are only recorded for the outermost structure lock of a thread
+ * (nested locks are attributed to the outermost call site).
+ */
+class tStructureLock : private rrlib::util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Recorded statistics for one call site */
+  struct tCallSiteStatistics
+  {
+    /*! Call site (e.g. name of function) */
+    const char* call_site;
+
+    /*! Number of (outermost) acquisitions */
+    uint64_t acquisitions;
+
+    /*! Cumulative time waited for mutex */
+    std::chrono::nanoseconds total_wait_time;
+
+    /*! Cumulative time mutex was held */
+    std::chrono::nanoseconds total_hold_time;
+
+    /*! Maximum time mutex was held */
+    std::chrono::nanoseconds max_hold_time;
+
+    explicit tCallSiteStatistics(const char* call_site = "") :
+      call_site(call_site),
+      acquisitions(0),
+      total_wait_time(0),
+      total_hold_time(0),
+      max_hold_time(0)
+    {}
+  };
+
+  /*!
+   * \param structure_mutex Runtime's structure mutex
+   * \param call_site Call site that acquires lock (must remain valid during program lifetime - e.g. a string literal.
+   *                  Statistics of call sites with equal names are merged)
+   */
+  tStructureLock(rrlib::thread::tRecursiveMutex& structure_mutex, const char* call_site) :
+    call_site(call_site),
+    wait_start(definitions::cPROFILE_STRUCTURE_LOCK ? tClock::now() : tClock::time_point()),
+    lock(structure_mutex)
+  {
+    if (definitions::cPROFILE_STRUCTURE_LOCK)
+    {
+      OnAcquire();
+    }
+  }
+
+  ~tStructureLock()
+  {
+    if (definitions::cPROFILE_STRUCTURE_LOCK)
+    {
+      OnRelease();
+    }
+  }
+
+  /*!
+   * (acquires structure mutex)
+   *
+   * \return Statistics of all call sites recorded so far - sorted by cumulative hold time (descending)
+   */
+  static std::vector<tCallSiteStatistics> GetStatistics();
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  typedef std::chrono::steady_clock tClock;
+
+  /*! Call site that acquires lock */
+  const char* call_site;
+
+  /*! Time when thread started waiting for mutex */
+  tClock::time_point wait_start;
+
+  /*! Wrapped lock */
+  rrlib::thread::tLock lock;
+
+
+  /*! Records statistics after mutex has been acquired */
+  void OnAcquire();
+
+  /*! Records statistics before mutex is released */
+  void OnRelease();
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
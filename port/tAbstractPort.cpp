@@ -40,7 +40,9 @@
 #include "core/tRuntimeEnvironment.h"
 #include "core/port/tEdgeAggregator.h"
 #include "core/port/tPortConnectionConstraint.h"
+#include "core/internal/tGarbageDeleter.h"
 #include "core/internal/tLinkEdge.h"
+#include "core/internal/tStructureLock.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -89,127 +91,473 @@ public:
 
 } // namespace internal
 
+/*!
+ * Hashed set of connection partners.
+ * Open addressing with atomic slots: May be read without lock while it is modified
+ * (with runtime structure lock acquired). Removed partners leave a marker in their slot,
+ * so that readers continue probing. As at most half of the slots are used, every probe sequence ends at an empty slot.
+ */
+struct tAbstractPort::tHashedConnectionSet : private rrlib::util::tNoncopyable
+{
+  /*! Number of slots (power of two) */
+  const size_t capacity;
+
+  /*! Number of slots that contain partners or removal markers */
+  size_t used_slot_count;
+
+  /*! Slots (NULL if empty) */
+  std::unique_ptr<std::atomic<const tAbstractPort*>[]> slots;
+
+  /*!
+   * \param partner_count Number of partners that set is created for
+   */
+  explicit tHashedConnectionSet(size_t partner_count) :
+    capacity(Capacity(partner_count)),
+    used_slot_count(0),
+    slots(new std::atomic<const tAbstractPort*>[capacity])
+  {
+    for (size_t i = 0; i < capacity; i++)
+    {
+      slots[i].store(NULL, std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \param partner Partner to look for
+   * \return Does set contain partner?
+   */
+  bool Contains(const tAbstractPort& partner) const
+  {
+    for (size_t i = Hash(partner); ; i = (i + 1) & (capacity - 1))
+    {
+      const tAbstractPort* slot = slots[i].load(std::memory_order_acquire);
+      if (slot == &partner)
+      {
+        return true;
+      }
+      if (slot == NULL)
+      {
+        return false;
+      }
+    }
+  }
+
+  /*!
+   * \return Can another partner be inserted? (otherwise a larger set needs to be created)
+   */
+  bool HasSpace() const
+  {
+    return (used_slot_count + 1) * 2 <= capacity;
+  }
+
+  /*!
+   * \param partner Partner to insert (must not be contained in set - and set must have space)
+   */
+  void Insert(const tAbstractPort& partner)
+  {
+    assert(HasSpace() && (!Contains(partner)));
+    size_t i = Hash(partner);
+    while (slots[i].load(std::memory_order_relaxed) != NULL)
+    {
+      i = (i + 1) & (capacity - 1);
+    }
+    slots[i].store(&partner, std::memory_order_release);
+    used_slot_count++;
+  }
+
+  /*!
+   * \param partner Partner to remove
+   */
+  void Remove(const tAbstractPort& partner)
+  {
+    for (size_t i = Hash(partner); slots[i].load(std::memory_order_relaxed) != NULL; i = (i + 1) & (capacity - 1))
+    {
+      if (slots[i].load(std::memory_order_relaxed) == &partner)
+      {
+        slots[i].store(RemovedMarker(), std::memory_order_release);
+        return;
+      }
+    }
+    assert(false && "Partner not in set");
+  }
+
+private:
+
+  /*! Number of slots for the specified number of partners (leaves room for as many insertions before set needs to be replaced) */
+  static size_t Capacity(size_t partner_count)
+  {
+    size_t capacity = 16;
+    while (capacity < partner_count * 4)
+    {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  /*! \return Index of first slot to probe for partner */
+  size_t Hash(const tAbstractPort& partner) const
+  {
+    return ((reinterpret_cast<uintptr_t>(&partner) >> 4) * 2654435761u) & (capacity - 1);
+  }
+
+  /*! \return Marker for slots of removed partners (never the address of a port) */
+  static const tAbstractPort* RemovedMarker()
+  {
+    static const char marker = 0;
+    return reinterpret_cast<const tAbstractPort*>(&marker);
+  }
+};
+
+namespace
+{
+
+/*!
+ * Creates hashed connection set containing all partners in connection set
+ *
+ * \param connections Connection set
+ * \param count Number of connections in connection set
+ * \return Hashed connection set
+ */
+template <typename THashedConnectionSet, typename TConnectionSet>
+THashedConnectionSet* CreateHashedConnectionSet(const TConnectionSet& connections, size_t count)
+{
+  THashedConnectionSet* hashed = new THashedConnectionSet(count);
+  for (auto it = connections.Begin(); it != connections.End(); ++it)
+  {
+    hashed->Insert(*it);
+  }
+  return hashed;
+}
+
+/*!
+ * Updates hashed connection set after partner has been added to connection set
+ *
+ * \param hashed Hashed connection set (created if connection set has grown beyond threshold - replaced by a larger one if it is full)
+ * \param connections Connection set
+ * \param count Number of connections in connection set
+ * \param threshold Number of connections beyond which hashed connection set is maintained
+ * \param partner Partner that has been added
+ */
+template <typename TConnectionSet, typename THashedConnectionSet>
+void AddHashedConnection(std::atomic<THashedConnectionSet*>& hashed, const TConnectionSet& connections, size_t count, size_t threshold, const tAbstractPort& partner)
+{
+  THashedConnectionSet* current = hashed.load(std::memory_order_relaxed);
+  if (current && current->HasSpace())
+  {
+    current->Insert(partner);
+  }
+  else if (current || count > threshold)
+  {
+    hashed.store(CreateHashedConnectionSet<THashedConnectionSet>(connections, count), std::memory_order_release);
+    internal::tGarbageDeleter::DeleteDeferred(current);  // lock-free readers might still use it
+  }
+}
+
+/*!
+ * Updates hashed connection set after partner has been removed from connection set
+ *
+ * \param hashed Hashed connection set (discarded if connection set has shrunk to half the threshold)
+ * \param count Number of connections in connection set
+ * \param threshold Number of connections beyond which hashed connection set is maintained
+ * \param partner Partner that has been removed
+ */
+template <typename THashedConnectionSet>
+void RemoveHashedConnection(std::atomic<THashedConnectionSet*>& hashed, size_t count, size_t threshold, const tAbstractPort& partner)
+{
+  THashedConnectionSet* current = hashed.load(std::memory_order_relaxed);
+  if (current)
+  {
+    if (count <= threshold / 2)
+    {
+      hashed.store(NULL, std::memory_order_release);
+      internal::tGarbageDeleter::DeleteDeferred(current);  // lock-free readers might still use it
+    }
+    else
+    {
+      current->Remove(partner);
+    }
+  }
+}
+
+/*!
+ * Updates number of paths to final target or from final source
+ *
+ * \param path_counts Number of paths to every final target/from every final source
+ * \param set Set of final targets/sources (port is added or removed if its number of paths changes from or to zero)
+ * \param port Final target/source
+ * \param added Was path added? (otherwise it was removed)
+ */
+template <typename TConnectionSet>
+void UpdatePathCount(std::unordered_map<const tAbstractPort*, size_t>& path_counts, TConnectionSet& set, tAbstractPort& port, bool added)
+{
+  if (added)
+  {
+    if ((path_counts[&port]++) == 0)
+    {
+      set.Add(&port);
+    }
+    return;
+  }
+  auto it = path_counts.find(&port);
+  assert(it != path_counts.end());
+  if ((--it->second) == 0)
+  {
+    path_counts.erase(it);
+    set.Remove(&port);
+  }
+}
+
+/*!
+ * \param hashed Hashed connection set - or NULL
+ * \param connections Connection set
+ * \param partner Partner to look for
+ * \return Does connection set contain partner?
+ */
+template <typename TConnectionSet, typename THashedConnectionSet>
+bool ContainsConnection(const THashedConnectionSet* hashed, const TConnectionSet& connections, const tAbstractPort& partner)
+{
+  if (hashed)
+  {
+    return hashed->Contains(partner);
+  }
+  for (auto it = connections.Begin(); it != connections.End(); ++it)
+  {
+    if (&(*it) == &partner)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+
 tAbstractPort::tAbstractPort(const tAbstractPortCreationInfo& info) :
   tFrameworkElement(info.parent, info.name, info.flags | tFlag::PORT),
   outgoing_connections(),
   incoming_connections(),
+  outgoing_connection_count(0),
+  incoming_connection_count(0),
+  input_port_path_count(0),
+  output_port_path_count(0),
+  hashed_outgoing_connections(NULL),
+  hashed_incoming_connections(NULL),
+  flattened_connections(NULL),
   link_edges(),
   wrapper_data_type(),
   data_type(info.data_type)
 {
+  GetRuntime().elements.UpdateDataType(GetHandle(), data_type.GetUid());
 }
 
 tAbstractPort::~tAbstractPort()
 {
+  delete flattened_connections.load();
+  delete hashed_outgoing_connections.load();
+  delete hashed_incoming_connections.load();
 }
 
-void tAbstractPort::Connect(const std::string& port1_link, const std::string& port2_link, tConnectDirection connect_direction)
+void tAbstractPort::CollectFinalSources(tAbstractPort& port, std::vector<tAbstractPort*>& result)
 {
-  if (port1_link.length() == 0 || port2_link.length() == 0)
+  if (!port.IsProxy())
   {
-    FINROC_LOG_PRINT_STATIC_TO(edges, ERROR, "No link name specified for partner port. Not connecting anything.");
+    result.push_back(&port);
     return;
   }
+  for (auto it = port.IncomingConnectionsBegin(); it != port.IncomingConnectionsEnd(); ++it)
+  {
+    CollectFinalSources(*it, result);
+  }
+}
 
-  rrlib::thread::tLock lock2(tRuntimeEnvironment::GetInstance().GetStructureMutex());
-  std::vector<std::unique_ptr<internal::tLinkEdge>>& global_link_edges = tRuntimeEnvironment::GetInstance().global_link_edges;
-
-  for (auto it = global_link_edges.begin(); it != global_link_edges.end(); ++it)
+void tAbstractPort::CollectFinalTargets(tAbstractPort& port, std::vector<tAbstractPort*>& result)
+{
+  if (!port.IsProxy())
   {
-    if (((*it)->GetTargetLink().compare(port1_link) == 0 && (*it)->GetSourceLink().compare(port2_link) == 0) ||
-        ((*it)->GetTargetLink().compare(port2_link) == 0 && (*it)->GetSourceLink().compare(port1_link) == 0))
-    {
-      return;
-    }
+    result.push_back(&port);
+    return;
   }
-  switch (connect_direction)
+  for (auto it = port.OutgoingConnectionsBegin(); it != port.OutgoingConnectionsEnd(); ++it)
   {
-  case tConnectDirection::AUTO:
-  case tConnectDirection::TO_TARGET:
-    global_link_edges.emplace_back(new internal::tLinkEdge(port1_link, port2_link, connect_direction == tConnectDirection::AUTO));
-    break;
-  case tConnectDirection::TO_SOURCE:
-    global_link_edges.emplace_back(new internal::tLinkEdge(port2_link, port1_link, false));
-    break;
+    CollectFinalTargets(*it, result);
   }
 }
 
-void tAbstractPort::ConnectImplementation(tAbstractPort& target, bool finstructed)
+void tAbstractPort::Connect(const std::string& port1_link, const std::string& port2_link, tConnectDirection connect_direction)
 {
-  tEdgeAggregator::EdgeAdded(*this, target);
+  if (port1_link.length() == 0 || port2_link.length() == 0)
+  {
+    FINROC_LOG_PRINT_STATIC_TO(edges, ERROR, "No link name specified for partner port. Not connecting anything.");
+    return;
+  }
 
-  this->outgoing_connections.Add(&target);
-  target.incoming_connections.Add(this);
-  if (finstructed)
+  internal::tStructureLock lock2(tRuntimeEnvironment::GetInstance().GetStructureMutex(), "tAbstractPort::Connect");
+  auto& global_link_edges = tRuntimeEnvironment::GetInstance().global_link_edges;
+  internal::tNamePool::tAtom link1 = internal::tNamePool::Find(port1_link);  // existing link edges hold references to their links
+  internal::tNamePool::tAtom link2 = internal::tNamePool::Find(port2_link);
+  if (link1 && link2 && (global_link_edges.find(std::make_pair(link1, link2)) != global_link_edges.end() || global_link_edges.find(std::make_pair(link2, link1)) != global_link_edges.end()))
   {
-    internal::tFinstructedEdgeInfo* info = GetAnnotation<internal::tFinstructedEdgeInfo>();
-    if (!info)
+    return;
+  }
+  bool to_source = connect_direction == tConnectDirection::TO_SOURCE;
+  internal::tLinkEdge* edge = new internal::tLinkEdge(to_source ? port2_link : port1_link, to_source ? port1_link : port2_link, connect_direction == tConnectDirection::AUTO);
+  global_link_edges[std::make_pair(&edge->GetSourceLink(), &edge->GetTargetLink())].reset(edge);
+}
+
+size_t tAbstractPort::ConnectAll(const tConnectionRequest* connections, size_t connection_count, std::vector<std::string>& error_messages)
+{
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  error_messages.assign(connection_count, std::string());
+  std::vector<std::pair<tAbstractPort*, tAbstractPort*>> created_edges;
+  created_edges.reserve(connection_count);
+
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tAbstractPort::ConnectAll");
+  runtime.BeginChangeBatch();
+  bool edges_aggregated = false;
+  try
+  {
+    for (size_t i = 0; i < connection_count; i++)
     {
-      info = new internal::tFinstructedEdgeInfo();
-      AddAnnotation<internal::tFinstructedEdgeInfo>(*info);
+      const tConnectionRequest& request = connections[i];
+      tConnectDirection connect_direction = request.connect_direction;
+      if (!(request.port1 && request.port2))
+      {
+        error_messages[i] = "No port specified.";
+      }
+      else if (request.port1->PrepareConnect(*request.port2, connect_direction, error_messages[i]))
+      {
+        tAbstractPort& source = (connect_direction == tConnectDirection::TO_TARGET) ? *request.port1 : *request.port2;
+        tAbstractPort& target = (connect_direction == tConnectDirection::TO_TARGET) ? *request.port2 : *request.port1;
+        source.ConnectImplementation(target, request.finstructed, false);
+        source.OnConnect(target, true);
+        target.OnConnect(source, false);
+        created_edges.push_back(std::make_pair(&source, &target));
+      }
+    }
+    edges_aggregated = true;
+    if (created_edges.size())
+    {
+      tEdgeAggregator::EdgesAdded(&created_edges[0], created_edges.size());
     }
-    info->outgoing_edges_finstructed.push_back(&target);
   }
-
-  PublishUpdatedEdgeInfo(tRuntimeListener::tEvent::ADD, target);
+  catch (...)
+  {
+    // connections created so far are not rolled back - so their edges need to be aggregated nonetheless
+    if ((!edges_aggregated) && created_edges.size())
+    {
+      tEdgeAggregator::EdgesAdded(&created_edges[0], created_edges.size());
+    }
+    runtime.EndChangeBatch();
+    throw;
+  }
+  runtime.EndChangeBatch();
+  return created_edges.size();
 }
 
-void tAbstractPort::ConnectTo(tAbstractPort& to, tConnectDirection connect_direction, bool finstructed)
+void tAbstractPort::ConnectByPattern(const std::string& port1_pattern, const std::string& port2_pattern, tConnectDirection connect_direction)
 {
-  rrlib::thread::tLock lock(GetStructureMutex());
-  if (IsDeleted() || to.IsDeleted())
+  if (port1_pattern.length() == 0 || port2_pattern.length() == 0)
   {
-    FINROC_LOG_PRINT(WARNING, "Port already deleted!");
+    FINROC_LOG_PRINT_STATIC_TO(edges, ERROR, "No link pattern specified for partner ports. Not connecting anything.");
     return;
   }
-  if (&to == this)
+  if (internal::tLinkPatternIndex::GetWildcardCount(port1_pattern) != internal::tLinkPatternIndex::GetWildcardCount(port2_pattern))
   {
-    FINROC_LOG_PRINT(WARNING, "Cannot connect port to itself.");
+    FINROC_LOG_PRINT_STATIC_TO(edges, ERROR, "Link patterns '", port1_pattern, "' and '", port2_pattern, "' contain different numbers of wildcards. Not connecting anything.");
     return;
   }
-  if (IsConnectedTo(to)) // already connected?
+
+  std::string pattern1 = port1_pattern[0] == '/' ? port1_pattern : ("/" + port1_pattern);
+  std::string pattern2 = port2_pattern[0] == '/' ? port2_pattern : ("/" + port2_pattern);
+  const std::string& source_pattern = connect_direction == tConnectDirection::TO_SOURCE ? pattern2 : pattern1;
+  const std::string& target_pattern = connect_direction == tConnectDirection::TO_SOURCE ? pattern1 : pattern2;
+  bool both_connect_directions = connect_direction == tConnectDirection::AUTO;
+
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tAbstractPort::ConnectByPattern");
+  if (!runtime.link_patterns.Add(source_pattern, target_pattern, both_connect_directions))
   {
     return;
   }
 
-  // determine connect direction
-  if (connect_direction == tConnectDirection::AUTO)
+  // connect ports that have already been published
+  const internal::tLinkPatternIndex::tPatternPair* pattern_pair = runtime.link_patterns.Find(source_pattern, target_pattern);
+  tRuntimeEnvironment::tElementFilter filter;
+  filter.flag_mask = tFlag::PORT | tFlag::READY | tFlag::PUBLISHED | tFlag::DELETED;
+  filter.flag_values = tFlag::PORT | tFlag::READY | tFlag::PUBLISHED;
+  enum { cBUFFER_SIZE = 256 };
+  tFrameworkElement* buffer[cBUFFER_SIZE];
+  tHandle start_handle = 0;
+  while (true)
   {
-    bool to_target_possible = MayConnectTo(to);
-    bool to_source_possible = to.MayConnectTo(*this);
-    if (to_target_possible && to_source_possible)
+    size_t count = runtime.FindElements(buffer, cBUFFER_SIZE, filter, start_handle);
+    for (size_t i = 0; i < count; i++)
     {
-      connect_direction = InferConnectDirection(to);
+      runtime.ConnectPatternMatches(static_cast<tAbstractPort&>(*buffer[i]), pattern_pair);
     }
-    else if (to_target_possible || to_source_possible)
+    if (count < cBUFFER_SIZE)
     {
-      connect_direction = to_target_possible ? tConnectDirection::TO_TARGET : tConnectDirection::TO_SOURCE;
+      break;
     }
-    else
+    start_handle = buffer[count - 1]->GetHandle() + 1;
+  }
+}
+
+void tAbstractPort::ConnectImplementation(tAbstractPort& target, bool finstructed, bool aggregate_edge)
+{
+  if (aggregate_edge)
+  {
+    tEdgeAggregator::EdgeAdded(*this, target);
+  }
+
+  assert((!ContainsConnection(hashed_outgoing_connections.load(), outgoing_connections, target)) && "Connection sets allow duplicates - so connection must not exist yet (see PrepareConnect())");
+  this->outgoing_connections.Add(&target);
+  target.incoming_connections.Add(this);
+  outgoing_connection_count++;
+  target.incoming_connection_count++;
+  AddHashedConnection(hashed_outgoing_connections, outgoing_connections, outgoing_connection_count.load(), cHASHED_CONNECTIONS_THRESHOLD, target);
+  AddHashedConnection(target.hashed_incoming_connections, target.incoming_connections, target.incoming_connection_count.load(), cHASHED_CONNECTIONS_THRESHOLD, *this);
+  UpdateFlattenedConnections(*this, target, true);
+  if (target.IsInputPort() || target.IsConnectedToInputPort())
+  {
+    UpdateInputPortPathCount(*this, 1);
+  }
+  if (IsOutputPort() || IsConnectedToOutputPort())
+  {
+    UpdateOutputPortPathCount(target, 1);
+  }
+  GetRuntime().elements.UpdateConnectionCount(GetHandle(), 0, 1);
+  GetRuntime().elements.UpdateConnectionCount(target.GetHandle(), 1, 0);
+  if (finstructed)
+  {
+    internal::tFinstructedEdgeInfo* info = GetAnnotation<internal::tFinstructedEdgeInfo>();
+    if (!info)
     {
-      std::string reason_string = "Could not connect ports '" + GetQualifiedName() + "' and '" + to.GetQualifiedName() + "' for the following reason: ";
-      MayConnectTo(to, &reason_string);
-      reason_string += "\nConnecting in the reverse direction did not work either: ";
-      to.MayConnectTo(*this, &reason_string);
-      FINROC_LOG_PRINT(WARNING, reason_string);
-      return;
+      info = new internal::tFinstructedEdgeInfo();
+      AddAnnotation<internal::tFinstructedEdgeInfo>(*info);
     }
+    info->outgoing_edges_finstructed.push_back(&target);
   }
 
-  // connect
-  tAbstractPort& source = (connect_direction == tConnectDirection::TO_TARGET) ? *this : to;
-  tAbstractPort& target = (connect_direction == tConnectDirection::TO_TARGET) ? to : *this;
-  std::string reason_string;
-  if (source.MayConnectTo(target, &reason_string))
+  PublishUpdatedEdgeInfo(tRuntimeListener::tEvent::ADD, target);
+}
+
+void tAbstractPort::ConnectTo(tAbstractPort& to, tConnectDirection connect_direction, bool finstructed)
+{
+  internal::tStructureLock lock(GetStructureMutex(), "tAbstractPort::ConnectTo");
+  std::string error_message;
+  if (PrepareConnect(to, connect_direction, error_message))
   {
-    FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Creating Edge from ", source.GetQualifiedName(), " to ", target.GetQualifiedName());
+    tAbstractPort& source = (connect_direction == tConnectDirection::TO_TARGET) ? *this : to;
+    tAbstractPort& target = (connect_direction == tConnectDirection::TO_TARGET) ? to : *this;
+    FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Creating Edge from ", source.GetQualifiedNameReference(), " to ", target.GetQualifiedNameReference());
     source.ConnectImplementation(target, finstructed);
     source.OnConnect(target, true);
     target.OnConnect(source, false);
   }
-  else
+  else if (error_message.length() > 0)
   {
-    FINROC_LOG_PRINT(WARNING, "Could not connect ports '" + GetQualifiedName() + "' and '" + to.GetQualifiedName() + "' for the following reason:\n- ", reason_string);
+    FINROC_LOG_PRINT(WARNING, error_message);
   }
 }
 
@@ -221,7 +569,7 @@ void tAbstractPort::ConnectTo(const tString& link_name, tConnectDirection connec
     return;
   }
 
-  rrlib::thread::tLock lock2(GetStructureMutex());
+  internal::tStructureLock lock2(GetStructureMutex(), "tAbstractPort::ConnectTo");
   if (IsDeleted())
   {
     FINROC_LOG_PRINT_TO(edges, WARNING, "Port already deleted!");
@@ -263,29 +611,32 @@ void tAbstractPort::ConnectTo(tFrameworkElement& partner_port_parent, const tStr
   }
 }
 
-size_t tAbstractPort::CountIncomingConnections() const
+bool tAbstractPort::Disconnect(const std::string& port1_link, const std::string& port2_link)
 {
-  size_t result = 0;
-  for (auto it = IncomingConnectionsBegin(); it != IncomingConnectionsEnd(); ++it)
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tAbstractPort::Disconnect");
+  internal::tNamePool::tAtom link1 = internal::tNamePool::Find(port1_link);
+  internal::tNamePool::tAtom link2 = internal::tNamePool::Find(port2_link);
+  if (!(link1 && link2))
   {
-    result++;
+    return false;
   }
-  return result;
-}
-
-size_t tAbstractPort::CountOutgoingConnections() const
-{
-  size_t result = 0;
-  for (auto it = OutgoingConnectionsBegin(); it != OutgoingConnectionsEnd(); ++it)
+  size_t erased = runtime.global_link_edges.erase(std::make_pair(link1, link2)) + runtime.global_link_edges.erase(std::make_pair(link2, link1));
+  if (erased)
   {
-    result++;
+    tAbstractPort* port1 = runtime.GetPort(port1_link);
+    tAbstractPort* port2 = runtime.GetPort(port2_link);
+    if (port1 && port2 && port1->IsConnectedTo(*port2))
+    {
+      port1->DisconnectFrom(*port2);
+    }
   }
-  return result;
+  return erased > 0;
 }
 
 void tAbstractPort::DisconnectAll(bool incoming, bool outgoing)
 {
-  rrlib::thread::tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tAbstractPort::DisconnectAll");
 
   // remove link edges
   if (link_edges != NULL)
@@ -320,11 +671,35 @@ void tAbstractPort::DisconnectAll(bool incoming, bool outgoing)
   }
 }
 
+bool tAbstractPort::DisconnectByPattern(const std::string& port1_pattern, const std::string& port2_pattern)
+{
+  if (port1_pattern.length() == 0 || port2_pattern.length() == 0)
+  {
+    return false;
+  }
+  std::string pattern1 = port1_pattern[0] == '/' ? port1_pattern : ("/" + port1_pattern);
+  std::string pattern2 = port2_pattern[0] == '/' ? port2_pattern : ("/" + port2_pattern);
+
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tAbstractPort::DisconnectByPattern");
+  bool removed = false;
+  for (size_t i = 0; i < 2; i++)
+  {
+    const internal::tLinkPatternIndex::tPatternPair* pattern_pair = i == 0 ? runtime.link_patterns.Find(pattern1, pattern2) : runtime.link_patterns.Find(pattern2, pattern1);
+    if (pattern_pair)
+    {
+      runtime.RemoveLinkPattern(*pattern_pair);
+      removed = true;
+    }
+  }
+  return removed;
+}
+
 void tAbstractPort::DisconnectFrom(tAbstractPort& target)
 {
   bool found = false;
   {
-    rrlib::thread::tLock lock(GetStructureMutex());
+    internal::tStructureLock lock(GetStructureMutex(), "tAbstractPort::DisconnectFrom");
     for (auto it = OutgoingConnectionsBegin(); it != OutgoingConnectionsEnd(); ++it)
     {
       if (&(*it) == &target)
@@ -352,7 +727,7 @@ void tAbstractPort::DisconnectFrom(tAbstractPort& target)
 
 void tAbstractPort::DisconnectFrom(const tString& link)
 {
-  rrlib::thread::tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tAbstractPort::DisconnectFrom");
   if (link_edges)
   {
     for (size_t i = 0; i < link_edges->size(); i++)
@@ -380,6 +755,21 @@ void tAbstractPort::DisconnectImplementation(tAbstractPort& source, tAbstractPor
 
   destination.incoming_connections.Remove(&source);
   source.outgoing_connections.Remove(&destination);
+  destination.incoming_connection_count--;
+  source.outgoing_connection_count--;
+  RemoveHashedConnection(destination.hashed_incoming_connections, destination.incoming_connection_count.load(), cHASHED_CONNECTIONS_THRESHOLD, source);
+  RemoveHashedConnection(source.hashed_outgoing_connections, source.outgoing_connection_count.load(), cHASHED_CONNECTIONS_THRESHOLD, destination);
+  UpdateFlattenedConnections(source, destination, false);
+  if (destination.IsInputPort() || destination.IsConnectedToInputPort())
+  {
+    UpdateInputPortPathCount(source, -1);
+  }
+  if (source.IsOutputPort() || source.IsConnectedToOutputPort())
+  {
+    UpdateOutputPortPathCount(destination, -1);
+  }
+  GetRuntime().elements.UpdateConnectionCount(source.GetHandle(), 0, -1);
+  GetRuntime().elements.UpdateConnectionCount(destination.GetHandle(), -1, 0);
 
   internal::tFinstructedEdgeInfo* info = source.GetAnnotation<internal::tFinstructedEdgeInfo>();
   if (info)
@@ -394,12 +784,70 @@ void tAbstractPort::DisconnectImplementation(tAbstractPort& source, tAbstractPor
   source.PublishUpdatedEdgeInfo(tRuntimeListener::tEvent::REMOVE, destination);
 }
 
+tAbstractPort::tIncomingConnectionIterator tAbstractPort::FinalSourcesBegin() const
+{
+  tFlattenedConnections* flattened = flattened_connections.load();
+  return flattened ? flattened->final_sources.Begin() : FinalSourcesEnd();
+}
+
+tAbstractPort::tIncomingConnectionIterator tAbstractPort::FinalSourcesEnd() const
+{
+  static const tIncomingConnectionSet cEMPTY_SET;
+  tFlattenedConnections* flattened = flattened_connections.load();
+  return flattened ? flattened->final_sources.End() : cEMPTY_SET.End();
+}
+
+tAbstractPort::tOutgoingConnectionIterator tAbstractPort::FinalTargetsBegin() const
+{
+  tFlattenedConnections* flattened = flattened_connections.load();
+  return flattened ? flattened->final_targets.Begin() : FinalTargetsEnd();
+}
+
+tAbstractPort::tOutgoingConnectionIterator tAbstractPort::FinalTargetsEnd() const
+{
+  static const tOutgoingConnectionSet cEMPTY_SET;
+  tFlattenedConnections* flattened = flattened_connections.load();
+  return flattened ? flattened->final_targets.End() : cEMPTY_SET.End();
+}
+
 std::vector<tPortConnectionConstraint*>& tAbstractPort::GetConnectionConstraintList()
 {
   typedef rrlib::design_patterns::tSingletonHolder<std::vector<tPortConnectionConstraint*>> tConstraintListSingleton;
   return tConstraintListSingleton::Instance();
 }
 
+void tAbstractPort::GetConnectedLinks(const std::string& link, std::vector<std::string>& result)
+{
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tAbstractPort::GetConnectedLinks");
+  internal::tNamePool::tAtom atom = internal::tNamePool::Find(link);
+  auto entry = atom ? runtime.link_edges.find(atom) : runtime.link_edges.end();
+  if (entry == runtime.link_edges.end())
+  {
+    return;
+  }
+  for (internal::tLinkEdge* le = entry->second; le; le = le->GetNextEdge())
+  {
+    const tString& source = le->GetSourceLink();
+    const tString& target = le->GetTargetLink();
+    if (source.length() > 0 && target.length() > 0)    // global link edge
+    {
+      result.push_back(&source == atom ? target : source);
+    }
+  }
+}
+
+tAbstractPort::tFlattenedConnections& tAbstractPort::GetFlattenedConnections()
+{
+  tFlattenedConnections* flattened = flattened_connections.load();
+  if (!flattened)
+  {
+    flattened = new tFlattenedConnections();
+    flattened_connections.store(flattened);
+  }
+  return *flattened;
+}
+
 tAbstractPort::tConnectDirection tAbstractPort::InferConnectDirection(const tAbstractPort& other) const
 {
   // If one port is no proxy port (only emits or accepts data), direction is clear
@@ -471,7 +919,7 @@ tAbstractPort::tConnectDirection tAbstractPort::InferConnectDirection(const tAbs
     else
     {
       FINROC_LOG_PRINTF(WARNING, "Two proxy ports ('%s' and '%s') in the same direction and on the same level are to be connected. Cannot infer direction. Guessing TO_TARGET.",
-                        this->GetQualifiedName().c_str(), other.GetQualifiedName().c_str());
+                        this->GetQualifiedNameReference().c_str(), other.GetQualifiedNameReference().c_str());
     }
   }
 
@@ -480,21 +928,8 @@ tAbstractPort::tConnectDirection tAbstractPort::InferConnectDirection(const tAbs
 
 bool tAbstractPort::IsConnectedTo(tAbstractPort& target) const
 {
-  for (auto it = OutgoingConnectionsBegin(); it != OutgoingConnectionsEnd(); ++it)
-  {
-    if (&(*it) == &target)
-    {
-      return true;
-    }
-  }
-  for (auto it = IncomingConnectionsBegin(); it != IncomingConnectionsEnd(); ++it)
-  {
-    if (&(*it) == &target)
-    {
-      return true;
-    }
-  }
-  return false;
+  return ContainsConnection(hashed_outgoing_connections.load(std::memory_order_acquire), outgoing_connections, target) ||
+         ContainsConnection(hashed_incoming_connections.load(std::memory_order_acquire), incoming_connections, target);
 }
 
 bool tAbstractPort::IsEdgeFinstructed(tAbstractPort& destination) const
@@ -521,7 +956,7 @@ tString tAbstractPort::MakeAbsoluteLink(const tString& rel_link) const
     rel_link2 = rel_link2.substr(3);
     relative_to = relative_to->GetParent();
   }
-  return relative_to->GetQualifiedLink() + "/" + rel_link2;
+  return relative_to->GetQualifiedLinkReference() + "/" + rel_link2;
 }
 
 bool tAbstractPort::MayConnectTo(tAbstractPort& target, std::string* reason_string) const
@@ -539,7 +974,7 @@ bool tAbstractPort::MayConnectTo(tAbstractPort& target, std::string* reason_stri
   {
     if (reason_string)
     {
-      (*reason_string) += "Port '" + this->GetQualifiedName() + "' does not emit data.";
+      (*reason_string) += "Port '" + this->GetQualifiedNameReference() + "' does not emit data.";
     }
     return false;
   }
@@ -548,7 +983,7 @@ bool tAbstractPort::MayConnectTo(tAbstractPort& target, std::string* reason_stri
   {
     if (reason_string)
     {
-      (*reason_string) += "Port '" + target.GetQualifiedName() + "' does not accept data.";
+      (*reason_string) += "Port '" + target.GetQualifiedNameReference() + "' does not accept data.";
     }
     return false;
   }
@@ -574,9 +1009,60 @@ bool tAbstractPort::MayConnectTo(tAbstractPort& target, std::string* reason_stri
   return true;
 }
 
+bool tAbstractPort::PrepareConnect(tAbstractPort& to, tConnectDirection& connect_direction, std::string& error_message)
+{
+  if (IsDeleted() || to.IsDeleted())
+  {
+    error_message = "Port already deleted!";
+    return false;
+  }
+  if (&to == this)
+  {
+    error_message = "Cannot connect port to itself.";
+    return false;
+  }
+  if (IsConnectedTo(to)) // already connected?
+  {
+    return false;
+  }
+
+  // determine connect direction
+  if (connect_direction == tConnectDirection::AUTO)
+  {
+    bool to_target_possible = MayConnectTo(to);
+    bool to_source_possible = to.MayConnectTo(*this);
+    if (to_target_possible && to_source_possible)
+    {
+      connect_direction = InferConnectDirection(to);
+    }
+    else if (to_target_possible || to_source_possible)
+    {
+      connect_direction = to_target_possible ? tConnectDirection::TO_TARGET : tConnectDirection::TO_SOURCE;
+    }
+    else
+    {
+      error_message = "Could not connect ports '" + GetQualifiedNameReference() + "' and '" + to.GetQualifiedNameReference() + "' for the following reason: ";
+      MayConnectTo(to, &error_message);
+      error_message += "\nConnecting in the reverse direction did not work either: ";
+      to.MayConnectTo(*this, &error_message);
+      return false;
+    }
+  }
+
+  tAbstractPort& source = (connect_direction == tConnectDirection::TO_TARGET) ? *this : to;
+  tAbstractPort& target = (connect_direction == tConnectDirection::TO_TARGET) ? to : *this;
+  std::string reason_string;
+  if (!source.MayConnectTo(target, &reason_string))
+  {
+    error_message = "Could not connect ports '" + GetQualifiedNameReference() + "' and '" + to.GetQualifiedNameReference() + "' for the following reason:\n- " + reason_string;
+    return false;
+  }
+  return true;
+}
+
 void tAbstractPort::PrepareDelete()
 {
-  rrlib::thread::tLock lock1(GetStructureMutex());
+  internal::tStructureLock lock1(GetStructureMutex(), "tAbstractPort::PrepareDelete");
 
   // disconnect all edges
   DisconnectAll();
@@ -593,6 +1079,69 @@ void tAbstractPort::SetWrapperDataType(const rrlib::rtti::tType& wrapper_data_ty
 }
 
 
+void tAbstractPort::UpdateFlattenedConnections(tAbstractPort& source, tAbstractPort& target, bool added)
+{
+  std::vector<tAbstractPort*> final_sources, final_targets;
+  CollectFinalSources(source, final_sources);
+  if (final_sources.empty())
+  {
+    return;
+  }
+  CollectFinalTargets(target, final_targets);
+  for (auto final_source = final_sources.begin(); final_source != final_sources.end(); ++final_source)
+  {
+    tFlattenedConnections& source_connections = (*final_source)->GetFlattenedConnections();
+    for (auto final_target = final_targets.begin(); final_target != final_targets.end(); ++final_target)
+    {
+      tFlattenedConnections& target_connections = (*final_target)->GetFlattenedConnections();
+      UpdatePathCount(source_connections.target_path_counts, source_connections.final_targets, **final_target, added);
+      UpdatePathCount(target_connections.source_path_counts, target_connections.final_sources, **final_source, added);
+    }
+  }
+}
+
+void tAbstractPort::UpdateInputPortPathCount(tAbstractPort& port, int delta)
+{
+  bool connected_before = port.IsConnectedToInputPort();
+  if (delta > 0)
+  {
+    port.input_port_path_count++;
+  }
+  else
+  {
+    port.input_port_path_count--;
+  }
+  bool connected_after = port.IsConnectedToInputPort();
+  if (connected_before != connected_after && (!port.IsInputPort()))   // sources of input ports count them anyway
+  {
+    for (auto it = port.IncomingConnectionsBegin(); it != port.IncomingConnectionsEnd(); ++it)
+    {
+      UpdateInputPortPathCount(*it, connected_after ? 1 : -1);
+    }
+  }
+}
+
+void tAbstractPort::UpdateOutputPortPathCount(tAbstractPort& port, int delta)
+{
+  bool connected_before = port.IsConnectedToOutputPort();
+  if (delta > 0)
+  {
+    port.output_port_path_count++;
+  }
+  else
+  {
+    port.output_port_path_count--;
+  }
+  bool connected_after = port.IsConnectedToOutputPort();
+  if (connected_before != connected_after && (!port.IsOutputPort()))   // targets of output ports count them anyway
+  {
+    for (auto it = port.OutgoingConnectionsBegin(); it != port.OutgoingConnectionsEnd(); ++it)
+    {
+      UpdateOutputPortPathCount(*it, connected_after ? 1 : -1);
+    }
+  }
+}
+
 //----------------------------------------------------------------------
 // End of namespace declaration
 //----------------------------------------------------------------------
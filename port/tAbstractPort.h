@@ -42,6 +42,7 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <unordered_map>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -93,15 +94,19 @@ class tPortConnectionConstraint;
 class tAbstractPort : public tFrameworkElement
 {
   // connection list types
-  typedef rrlib::concurrent_containers::tSet < tAbstractPort*, rrlib::concurrent_containers::tAllowDuplicates::NO, rrlib::thread::tNoMutex,
+  // (duplicates are allowed, so that adding does not scan the set: PrepareConnect() already rejects connections that exist)
+  typedef rrlib::concurrent_containers::tSet < tAbstractPort*, rrlib::concurrent_containers::tAllowDuplicates::YES, rrlib::thread::tNoMutex,
           rrlib::concurrent_containers::set::storage::ArrayChunkBased<2, 9, definitions::cSINGLE_THREADED>, true > tOutgoingConnectionSet;
-  typedef rrlib::concurrent_containers::tSet < tAbstractPort*, rrlib::concurrent_containers::tAllowDuplicates::NO, rrlib::thread::tNoMutex,
+  typedef rrlib::concurrent_containers::tSet < tAbstractPort*, rrlib::concurrent_containers::tAllowDuplicates::YES, rrlib::thread::tNoMutex,
           rrlib::concurrent_containers::set::storage::ArrayChunkBased<1, 9, definitions::cSINGLE_THREADED>, true > tIncomingConnectionSet;
 
   // iterator type
   typedef tOutgoingConnectionSet::tConstIterator tOutgoingConnectionIterator;
   typedef tIncomingConnectionSet::tConstIterator tIncomingConnectionIterator;
 
+  /*! Hashed set of connection partners (for ports with many connections - may be read without lock) */
+  struct tHashedConnectionSet;
+
 //----------------------------------------------------------------------
 // Public methods and typedefs
 //----------------------------------------------------------------------
@@ -117,6 +122,26 @@ public:
     TO_SOURCE  //!< Specified port is source port
   };
 
+  /*! Connection to create using ConnectAll() */
+  struct tConnectionRequest
+  {
+    /*! Ports to connect */
+    tAbstractPort* port1, * port2;
+
+    /*! Direction for connection (TO_TARGET means that the second port is the target port) */
+    tConnectDirection connect_direction;
+
+    /*! Is this a finstructed connection? */
+    bool finstructed;
+
+    tConnectionRequest(tAbstractPort& port1, tAbstractPort& port2, tConnectDirection connect_direction = tConnectDirection::AUTO, bool finstructed = false) :
+      port1(&port1),
+      port2(&port2),
+      connect_direction(connect_direction),
+      finstructed(finstructed)
+    {}
+  };
+
   tAbstractPort(const tAbstractPortCreationInfo& creation_info);
 
   /*!
@@ -130,6 +155,43 @@ public:
    */
   static void Connect(const std::string& port1_link, const std::string& port2_link, tConnectDirection connect_direction = tConnectDirection::AUTO);
 
+  /*!
+   * Creates many connections in one structure operation.
+   * This is a lot more efficient than calling ConnectTo() for every pair of ports:
+   * The structure lock is acquired once, edges are aggregated in one pass
+   * and runtime listeners are notified of all new connections in one batch.
+   * If an exception occurs (e.g. in a port's OnConnect()), it is passed on to the caller.
+   * There is no rollback: connections created before remain - their edges are aggregated
+   * and runtime listeners are notified of them as if ConnectAll() had completed.
+   *
+   * \param connections Pointer to first element of array with connections to create
+   * \param connection_count Number of connections in array
+   * \param error_messages Is resized to 'connection_count'. Contains an error message for every connection that could not be created - and an empty string otherwise (also if ports were already connected).
+   * \return Number of connections that were created
+   */
+  static size_t ConnectAll(const tConnectionRequest* connections, size_t connection_count, std::vector<std::string>& error_messages);
+
+  /*!
+   * Connects all ports with links matching the two specified patterns.
+   * A '*' in a pattern matches any sequence of characters within one path element.
+   * Both patterns must contain the same number of wildcards:
+   * Ports are connected whose links are equal when the wildcards are replaced with the same strings (in order).
+   * E.g. with the patterns "/Sensors/X/Scan" and "/Fusion/Input/X" - X being the wildcard '*' -
+   * "/Sensors/Lidar/Scan" is connected to "/Fusion/Input/Lidar".
+   *
+   * Ports that have already been published are connected immediately.
+   * Ports published later are connected as they appear.
+   * For every matching port, a link edge to the link at the other end is created - which is deleted with the port
+   * (so patterns do not accumulate link edges if ports with varying names are created and deleted dynamically).
+   * Patterns can be removed using DisconnectByPattern().
+   *
+   * \param port1_pattern Link pattern of first ports to connect
+   * \param port2_pattern Link pattern of second ports to connect
+   * \param connect_direction Direction for connections. "AUTO" should be appropriate for almost any situation. However, another direction may be enforced.
+   *                          (TO_TARGET means that the second ports are the target ports)
+   */
+  static void ConnectByPattern(const std::string& port1_pattern, const std::string& port2_pattern, tConnectDirection connect_direction = tConnectDirection::AUTO);
+
   /*!
    * Connect port to specified partner port
    *
@@ -160,14 +222,30 @@ public:
   void ConnectTo(tFrameworkElement& partner_port_parent, const tString& port_name, bool warn_if_not_available = true, tConnectDirection connect_direction = tConnectDirection::AUTO);
 
   /*!
-   * \return Number of incoming connections (slightly expensive operation - O(n))
+   * \return Number of incoming connections
+   */
+  size_t CountIncomingConnections() const
+  {
+    return incoming_connection_count.load();
+  }
+
+  /*!
+   * \return Number of outgoing connections
    */
-  size_t CountIncomingConnections() const;
+  size_t CountOutgoingConnections() const
+  {
+    return outgoing_connection_count.load();
+  }
 
   /*!
-   * \return Number of incoming connections (slightly expensive operation - O(n))
+   * Removes connection between ports with the two specified links that was created using Connect(port1_link, port2_link).
+   * Disconnects the two ports if they currently exist.
+   *
+   * \param port1_link Link name of first port
+   * \param port2_link Link name of second port
+   * \return True, if such a connection existed (in any direction)
    */
-  size_t CountOutgoingConnections() const;
+  static bool Disconnect(const std::string& port1_link, const std::string& port2_link);
 
   /*!
    * Disconnects all edges
@@ -177,6 +255,17 @@ public:
    */
   void DisconnectAll(bool incoming = true, bool outgoing = true);
 
+  /*!
+   * Removes link patterns that were added using ConnectByPattern(port1_pattern, port2_pattern).
+   * Connections that were created because of these patterns are removed.
+   * Connections between matching ports that existed before - or were created otherwise - remain.
+   *
+   * \param port1_pattern Link pattern of first ports
+   * \param port2_pattern Link pattern of second ports
+   * \return True, if such patterns existed (in any direction)
+   */
+  static bool DisconnectByPattern(const std::string& port1_pattern, const std::string& port2_pattern);
+
   /*!
    * Disconnect from specified port
    *
@@ -191,6 +280,43 @@ public:
    */
   void DisconnectFrom(const tString& link);
 
+  /*!
+   * Final sources of a port that is no proxy port (see IsProxy()):
+   * All non-proxy ports that data arriving at this port originates from - connected directly or via chains of proxy ports.
+   * Maintained whenever connections are added or removed. Proxy ports have no final sources.
+   *
+   * \return An iterator to iterate over all final sources of this port
+   */
+  tIncomingConnectionIterator FinalSourcesBegin() const;
+
+  /*!
+   * \return An iterator to iterate over all final sources of this port pointing to the past-the-end element.
+   */
+  tIncomingConnectionIterator FinalSourcesEnd() const;
+
+  /*!
+   * Final targets of a port that is no proxy port (see IsProxy()):
+   * All non-proxy ports that data published via this port arrives at - connected directly or via chains of proxy ports.
+   * So, e.g. publishing plugins can deliver data to these ports without walking intermediate proxy ports.
+   * Maintained whenever connections are added or removed. Proxy ports have no final targets.
+   *
+   * \return An iterator to iterate over all final targets of this port
+   */
+  tOutgoingConnectionIterator FinalTargetsBegin() const;
+
+  /*!
+   * \return An iterator to iterate over all final targets of this port pointing to the past-the-end element.
+   */
+  tOutgoingConnectionIterator FinalTargetsEnd() const;
+
+  /*!
+   * Obtains links that the specified link was connected to using Connect(port1_link, port2_link).
+   *
+   * \param link Link name of port
+   * \param result Vector to append links of connection partners to
+   */
+  static void GetConnectedLinks(const std::string& link, std::vector<std::string>& result);
+
   /*!
    * \return Data type of port
    */
@@ -270,35 +396,32 @@ public:
   bool IsConnectedTo(tAbstractPort& target) const;
 
   /*! Check if output ports have a data sink
+   * (O(1) - maintained when connections are added or removed)
    *
-   * \return Is \a this port currently connected to an input port?
+   * \return Is \a this port currently connected to an input port? (directly or via proxy ports)
    */
   inline bool IsConnectedToInputPort() const
   {
-    for (auto it = this->OutgoingConnectionsBegin(); it != this->OutgoingConnectionsEnd(); ++it)
-    {
-      if (it->IsInputPort() || it->IsConnectedToInputPort())
-      {
-        return true;
-      }
-    }
-    return false;
+    return input_port_path_count.load() > 0;
   }
 
   /*! Check if input ports have a data source
+   * (O(1) - maintained when connections are added or removed)
    *
-   * \return Is \a this port currently connected to an output port?
+   * \return Is \a this port currently connected to an output port? (directly or via proxy ports)
    */
   inline bool IsConnectedToOutputPort() const
   {
-    for (auto it = this->IncomingConnectionsBegin(); it != this->IncomingConnectionsEnd(); ++it)
-    {
-      if (it->IsOutputPort() || it->IsConnectedToOutputPort())
-      {
-        return true;
-      }
-    }
-    return false;
+    return output_port_path_count.load() > 0;
+  }
+
+  /*!
+   * \return Is this a proxy port - forwarding the data it receives (port that accepts and emits data, e.g. in interfaces)?
+   * (network ports are no proxy ports, since they forward data to other processes)
+   */
+  inline bool IsProxy() const
+  {
+    return GetFlag(tFlag::ACCEPTS_DATA) && GetFlag(tFlag::EMITS_DATA) && (!GetFlag(tFlag::NETWORK_ELEMENT));
   }
 
   /*!
@@ -405,6 +528,55 @@ private:
   /*! Edges ending at this port */
   tIncomingConnectionSet incoming_connections;
 
+  /*! Number of edges in outgoing_connections and incoming_connections */
+  std::atomic<size_t> outgoing_connection_count, incoming_connection_count;
+
+  /*!
+   * Number of outgoing connections to ports that are input ports or connected to an input port
+   * (port is connected to an input port if > 0 - see IsConnectedToInputPort())
+   */
+  std::atomic<size_t> input_port_path_count;
+
+  /*!
+   * Number of incoming connections from ports that are output ports or connected to an output port
+   * (port is connected to an output port if > 0 - see IsConnectedToOutputPort())
+   */
+  std::atomic<size_t> output_port_path_count;
+
+  /*!
+   * Hashed copies of outgoing_connections and incoming_connections - NULL if they do not exist.
+   * Only exist while port has more than cHASHED_CONNECTIONS_THRESHOLD connections in the respective direction.
+   * Make IsConnectedTo() - and therefore the duplicate check when connecting - O(1) for ports with many connections.
+   * (removing a connection still scans the connection sets above)
+   * May be read without lock - like the connection sets above. Modified with runtime structure lock only.
+   * Sets that are replaced (when they grow) or discarded are deleted by the tGarbageDeleter.
+   */
+  std::atomic<tHashedConnectionSet*> hashed_outgoing_connections, hashed_incoming_connections;
+
+  /*! Number of connections in one direction beyond which hashed connection sets are maintained */
+  enum { cHASHED_CONNECTIONS_THRESHOLD = 16 };
+
+  /*! Flattened connections of port that is no proxy port (see FinalTargetsBegin()) */
+  struct tFlattenedConnections
+  {
+    /*! Final targets and sources */
+    tOutgoingConnectionSet final_targets;
+    tIncomingConnectionSet final_sources;
+
+    /*! Number of paths to every final target and from every final source (may only be accessed with structure lock) */
+    std::unordered_map<const tAbstractPort*, size_t> target_path_counts, source_path_counts;
+
+    tFlattenedConnections() :
+      final_targets(),
+      final_sources(),
+      target_path_counts(),
+      source_path_counts()
+    {}
+  };
+
+  /*! Flattened connections - created when port obtains first final target or source (deleted with port) */
+  std::atomic<tFlattenedConnections*> flattened_connections;
+
   /*! Contains any link edges created by this port */
   std::unique_ptr<std::vector<internal::tLinkEdge*>> link_edges;
 
@@ -424,8 +596,9 @@ private:
    *
    * \param target Target to connect to
    * \param finstructed Was edge created using finstruct?
+   * \param aggregate_edge Notify edge aggregators? (ConnectAll() does this for all edges at once)
    */
-  void ConnectImplementation(tAbstractPort& target, bool finstructed);
+  void ConnectImplementation(tAbstractPort& target, bool finstructed, bool aggregate_edge = true);
 
   /*!
    * Implementation of actual removement of edge (updates internal variables etc.)
@@ -482,8 +655,74 @@ private:
   {
   }
 
+  /*!
+   * Checks whether port can be connected to specified port - and determines direction
+   * (must be called with structure lock)
+   *
+   * \param to Port to connect to
+   * \param connect_direction Desired direction. Contains actual direction (TO_TARGET or TO_SOURCE) if function returns true.
+   * \param error_message Contains reason if ports cannot be connected (stays empty if ports are already connected)
+   * \return True, if ports should be connected
+   */
+  bool PrepareConnect(tAbstractPort& to, tConnectDirection& connect_direction, std::string& error_message);
+
   virtual void PrepareDelete() override;
 
+  /*!
+   * Appends final sources of port to result (port itself if it is no proxy port)
+   * (must be called with structure lock)
+   *
+   * \param port Port
+   * \param result Result vector (contains sources once per path)
+   */
+  static void CollectFinalSources(tAbstractPort& port, std::vector<tAbstractPort*>& result);
+
+  /*!
+   * Appends final targets of port to result (port itself if it is no proxy port)
+   * (must be called with structure lock)
+   *
+   * \param port Port
+   * \param result Result vector (contains targets once per path)
+   */
+  static void CollectFinalTargets(tAbstractPort& port, std::vector<tAbstractPort*>& result);
+
+  /*!
+   * \return Flattened connections of this port (created if they do not exist yet - requires structure lock)
+   */
+  tFlattenedConnections& GetFlattenedConnections();
+
+  /*!
+   * Updates flattened connections of all final sources of 'source' and all final targets of 'target'
+   * after edge from 'source' to 'target' has been added or removed
+   * (must be called with structure lock; connections must not form cycles)
+   *
+   * \param source Source port of edge
+   * \param target Target port of edge
+   * \param added Was edge added? (otherwise it was removed)
+   */
+  static void UpdateFlattenedConnections(tAbstractPort& source, tAbstractPort& target, bool added);
+
+  /*!
+   * Updates input_port_path_count of port.
+   * If this changes whether port is connected to an input port, the ports with connections to this port are updated as well
+   * (so updates are limited to the affected chain of proxy ports).
+   * (must be called with structure lock; connections must not form cycles)
+   *
+   * \param port Port to update
+   * \param delta Change of count (1 or -1)
+   */
+  static void UpdateInputPortPathCount(tAbstractPort& port, int delta);
+
+  /*!
+   * Updates output_port_path_count of port.
+   * If this changes whether port is connected to an output port, the ports connected from this port are updated as well.
+   * (must be called with structure lock; connections must not form cycles)
+   *
+   * \param port Port to update
+   * \param delta Change of count (1 or -1)
+   */
+  static void UpdateOutputPortPathCount(tAbstractPort& port, int delta);
+
 };
 
 //----------------------------------------------------------------------
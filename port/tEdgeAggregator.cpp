@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <map>
+#include <unordered_map>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -85,18 +87,51 @@ void tEdgeAggregator::EdgeAdded(tAbstractPort& source, tAbstractPort& target)
   }
 }
 
-void tEdgeAggregator::EdgeAdded(tEdgeAggregator& dest, bool data_flow_type)
+void tEdgeAggregator::EdgesAdded(const std::pair<tAbstractPort*, tAbstractPort*>* edges, size_t edge_count)
+{
+  // count edges per pair of aggregators (ports in the same parent element have the same aggregator)
+  std::unordered_map<tFrameworkElement*, tEdgeAggregator*> aggregators;
+  std::map<std::pair<tEdgeAggregator*, tEdgeAggregator*>, std::pair<int, int>> counts;
+  for (size_t i = 0; i < edge_count; i++)
+  {
+    tEdgeAggregator* aggregator[2];
+    for (size_t j = 0; j < 2; j++)
+    {
+      tAbstractPort& port = j == 0 ? *edges[i].first : *edges[i].second;
+      auto cached = aggregators.find(port.GetParent());
+      if (cached == aggregators.end())
+      {
+        cached = aggregators.insert(std::make_pair(port.GetParent(), GetAggregator(port))).first;
+      }
+      aggregator[j] = cached->second;
+    }
+    if (aggregator[0] && aggregator[1])
+    {
+      std::pair<int, int>& count = counts[std::make_pair(aggregator[0], aggregator[1])];
+      (IsDataFlowType(edges[i].first->GetDataType()) ? count.first : count.second)++;
+    }
+  }
+
+  for (auto it = counts.begin(); it != counts.end(); ++it)
+  {
+    it->first.first->EdgesAdded(*it->first.second, it->second.first, it->second.second);
+  }
+}
+
+void tEdgeAggregator::EdgesAdded(tEdgeAggregator& dest, int data_flow_edge_count, int control_flow_edge_count)
 {
   tAggregatedEdge* ae = FindAggregatedEdge(dest);
   if (ae != NULL)
   {
-    ae->GetCountVariable(data_flow_type)++;
+    ae->data_flow_edge_count += data_flow_edge_count;
+    ae->control_flow_edge_count += control_flow_edge_count;
     return;
   }
 
   // not found
   ae = new tAggregatedEdge(*this, dest);
-  ae->GetCountVariable(data_flow_type) = 1;
+  ae->data_flow_edge_count = data_flow_edge_count;
+  ae->control_flow_edge_count = control_flow_edge_count;
   emerging_edges.Add(ae);
   dest.incoming_edges.Add(ae);
 }
@@ -96,6 +96,16 @@ public:
    */
   static void EdgeAdded(tAbstractPort& source, tAbstractPort& target);
 
+  /*!
+   * (Should be called by abstract port only - with runtime registry locked)
+   * Notify parent aggregators that many edges have been added.
+   * Edges with the same aggregators are counted first - so every aggregated edge is only looked up once.
+   *
+   * \param edges Pointer to first element of array with (source port, target port) of added edges
+   * \param edge_count Number of edges in array
+   */
+  static void EdgesAdded(const std::pair<tAbstractPort*, tAbstractPort*>* edges, size_t edge_count);
+
   /*!
    * (Should be called by abstract port only - with runtime registry locked)
    * Notify parent aggregators that edge has been removed
@@ -183,7 +193,19 @@ private:
    * \param dest Destination aggregating element
    * \param data_flow_type Was a data flow edge added?
    */
-  void EdgeAdded(tEdgeAggregator& dest, bool data_flow_type);
+  void EdgeAdded(tEdgeAggregator& dest, bool data_flow_type)
+  {
+    EdgesAdded(dest, data_flow_type ? 1 : 0, data_flow_type ? 0 : 1);
+  }
+
+  /*!
+   * Called when edges have been added that are relevant for this element
+   *
+   * \param dest Destination aggregating element
+   * \param data_flow_edge_count Number of data flow edges added
+   * \param control_flow_edge_count Number of control flow edges added
+   */
+  void EdgesAdded(tEdgeAggregator& dest, int data_flow_edge_count, int control_flow_edge_count);
 
   /*!
    * Called when edge has been added that is relevant for this element
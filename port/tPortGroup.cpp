@@ -32,11 +32,15 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <algorithm>
+#include <map>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "core/port/tPortFactory.h"
+#include "core/internal/tGarbageDeleter.h"
+#include "core/internal/tStructureLock.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -63,58 +67,99 @@ namespace core
 // Const values
 //----------------------------------------------------------------------
 
+/*! Initial capacity of port tables */
+const size_t cINITIAL_PORT_TABLE_CAPACITY = 8;
+
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
 
+struct tPortGroup::tPortTable
+{
+  /*! Number of ports that table has room for */
+  const size_t capacity;
+
+  /*! Number of ports in table (entries below this index are never modified - so they may be read without lock) */
+  std::atomic<size_t> size;
+
+  /*! Ports */
+  std::unique_ptr<tAbstractPort*[]> ports;
+
+  explicit tPortTable(size_t capacity) :
+    capacity(capacity),
+    size(0),
+    ports(new tAbstractPort*[capacity])
+  {}
+};
+
+namespace
+{
+
+/*! Orders ports by name - ignoring name prefix of specified length */
+struct tNameOrder
+{
+  size_t prefix_length;
+
+  tNameOrder(size_t prefix_length) : prefix_length(prefix_length) {}
+
+  bool operator()(const tAbstractPort* port1, const tAbstractPort* port2) const
+  {
+    return port1->GetName().compare(prefix_length, std::string::npos, port2->GetName(), prefix_length, std::string::npos) < 0;
+  }
+};
+
+}
+
 tPortGroup::tPortGroup(tFrameworkElement* parent, const std::string& name, tFlags flags, tFlags default_port_flags) :
   tEdgeAggregator(parent, name, flags),
-  default_port_flags(default_port_flags)
+  default_port_flags(default_port_flags),
+  port_table(new tPortTable(cINITIAL_PORT_TABLE_CAPACITY)),
+  frozen_ports(NULL),
+  frozen_tables()
+{
+}
+
+tPortGroup::~tPortGroup()
 {
+  delete port_table.load();
 }
 
 void tPortGroup::ConnectImpl(tPortGroup* other_group, const std::string& group_link, bool create_missing_ports, tAbstractPort* start_with, int count, const std::string& port_prefix, const std::string& other_port_prefix)
 {
+  internal::tStructureLock lock(GetStructureMutex(), "tPortGroup::ConnectImpl");
+
+  // collect ports to connect
   int org_count = count;
-  for (auto it = ChildPortsBegin(); it != ChildPortsEnd(); ++it)
+  std::vector<tAbstractPort*> ports;
+  for (auto it = ChildPortsBegin(); it != ChildPortsEnd() && count != 0; ++it)
   {
     tAbstractPort& child_port = *it;
-    std::string name(child_port.GetName());
     if (&child_port == start_with)
     {
       start_with = NULL;
     }
-    if (start_with || (name.compare(0, port_prefix.length(), port_prefix)) != 0) // skip if we have not reached start port or port does not start with 'port_prefix'?
+    if (start_with || (child_port.GetName().compare(0, port_prefix.length(), port_prefix)) != 0) // skip if we have not reached start port or port does not start with 'port_prefix'?
     {
       continue;
     }
-    if (count == 0)
-    {
-      return;
-    }
     count--;
-    name = name.substr(port_prefix.length());
+    ports.push_back(&child_port);
+  }
 
-    // connect-function-specific part
-    if (other_group)
-    {
-      tFrameworkElement* other_child_port = other_group->GetChild(other_port_prefix + name);
-      if (other_child_port && other_child_port->IsPort())
-      {
-        child_port.ConnectTo(static_cast<tAbstractPort&>(*other_child_port));
-      }
-      else if (create_missing_ports)
-      {
-        other_child_port = other_group->CreatePort(other_port_prefix + name, child_port.GetDataType());
-        child_port.ConnectTo(static_cast<tAbstractPort&>(*other_child_port));
-      }
-    }
-    else if (group_link.length() > 0)
+  // connect-function-specific part
+  if (other_group)
+  {
+    ConnectByNameImpl(*other_group, ports, create_missing_ports, port_prefix, other_port_prefix);
+  }
+  else if (group_link.length() > 0)
+  {
+    for (auto it = ports.begin(); it != ports.end(); ++it)
     {
-      child_port.ConnectTo(group_link + "/" + other_port_prefix + name);
+      (*it)->ConnectTo(group_link + "/" + other_port_prefix + (*it)->GetName().substr(port_prefix.length()));
     }
-    // connect-function-specific part end
   }
+  // connect-function-specific part end
+
   if (start_with)
   {
     FINROC_LOG_PRINT(WARNING, "Port ", start_with->GetQualifiedName(), " no child of ", this->GetQualifiedName(), ". Did not connect anything.");
@@ -125,6 +170,87 @@ void tPortGroup::ConnectImpl(tPortGroup* other_group, const std::string& group_l
   }
 }
 
+void tPortGroup::ConnectByNameImpl(tPortGroup& other_group, const std::vector<tAbstractPort*>& ports, bool create_missing_ports, const std::string& port_prefix, const std::string& other_port_prefix)
+{
+  // Sort ports of both groups by name (without prefixes) and merge-join them
+  std::vector<tAbstractPort*> sorted_ports(ports);
+  std::stable_sort(sorted_ports.begin(), sorted_ports.end(), tNameOrder(port_prefix.length()));
+  std::vector<tAbstractPort*> other_ports;
+  for (auto it = other_group.ChildPortsBegin(); it != other_group.ChildPortsEnd(); ++it)
+  {
+    if ((!it->IsDeleted()) && it->GetName().compare(0, other_port_prefix.length(), other_port_prefix) == 0)
+    {
+      other_ports.push_back(&(*it));
+    }
+  }
+  std::stable_sort(other_ports.begin(), other_ports.end(), tNameOrder(other_port_prefix.length()));
+
+  std::vector<tAbstractPort::tConnectionRequest> connections;
+  std::vector<tAbstractPort*> unmatched_ports;
+  auto other = other_ports.begin();
+  for (auto it = sorted_ports.begin(); it != sorted_ports.end(); ++it)
+  {
+    const tString& name = (*it)->GetName();
+    int comparison = 1;
+    while (other != other_ports.end() && (comparison = (*other)->GetName().compare(other_port_prefix.length(), std::string::npos, name, port_prefix.length(), std::string::npos)) < 0)
+    {
+      ++other;
+    }
+    if (other != other_ports.end() && comparison == 0)
+    {
+      connections.push_back(tAbstractPort::tConnectionRequest(**it, **other));
+    }
+    else if (create_missing_ports)
+    {
+      unmatched_ports.push_back(*it);
+    }
+  }
+
+  // create missing ports (in order of ports in this group - once per name)
+  if (unmatched_ports.size())
+  {
+    std::sort(unmatched_ports.begin(), unmatched_ports.end());
+    std::vector<std::pair<std::string, rrlib::rtti::tType>> missing_ports;
+    std::map<std::string, size_t> missing_port_indices;
+    std::vector<std::pair<tAbstractPort*, size_t>> missing_port_partners;
+    for (auto it = ports.begin(); it != ports.end(); ++it)
+    {
+      if (std::binary_search(unmatched_ports.begin(), unmatched_ports.end(), *it))
+      {
+        std::string name = other_port_prefix + (*it)->GetName().substr(port_prefix.length());
+        auto index = missing_port_indices.insert(std::make_pair(name, missing_ports.size())).first;
+        if (index->second == missing_ports.size())
+        {
+          missing_ports.push_back(std::make_pair(name, (*it)->GetDataType()));
+        }
+        missing_port_partners.push_back(std::make_pair(*it, index->second));
+      }
+    }
+    std::vector<tAbstractPort*> created_ports;
+    other_group.CreatePorts(missing_ports, created_ports);
+    for (auto it = missing_port_partners.begin(); it != missing_port_partners.end(); ++it)
+    {
+      if (created_ports[it->second])
+      {
+        connections.push_back(tAbstractPort::tConnectionRequest(*it->first, *created_ports[it->second]));
+      }
+    }
+  }
+
+  if (connections.size())
+  {
+    std::vector<std::string> error_messages;
+    tAbstractPort::ConnectAll(&connections[0], connections.size(), error_messages);
+    for (auto it = error_messages.begin(); it != error_messages.end(); ++it)
+    {
+      if (it->length() > 0)
+      {
+        FINROC_LOG_PRINT(WARNING, *it);
+      }
+    }
+  }
+}
+
 tAbstractPort* tPortGroup::CreatePort(const std::string& name, rrlib::rtti::tType type, tFlags extra_flags)
 {
   FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Creating port ", name, " in IOVector ", this->GetQualifiedLink());
@@ -138,6 +264,26 @@ tAbstractPort* tPortGroup::CreatePort(const std::string& name, rrlib::rtti::tTyp
   return ap;
 }
 
+void tPortGroup::CreatePorts(const std::vector<std::pair<std::string, rrlib::rtti::tType>>& ports, std::vector<tAbstractPort*>& created_ports, tFlags extra_flags)
+{
+  FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Creating ", ports.size(), " ports in IOVector ", this->GetQualifiedLink());
+  internal::tStructureLock lock(GetStructureMutex(), "tPortGroup::CreatePorts");
+  created_ports.clear();
+  created_ports.reserve(ports.size());
+  for (auto it = ports.begin(); it != ports.end(); ++it)
+  {
+    created_ports.push_back(tPortFactory::CreatePort(it->first, *this, it->second, default_port_flags | extra_flags));
+  }
+
+  for (auto it = created_ports.begin(); it != created_ports.end(); ++it)
+  {
+    if (*it)
+    {
+      (*it)->Init();
+    }
+  }
+}
+
 void tPortGroup::DisconnectAll(bool incoming, bool outgoing, tAbstractPort* start_with, int count)
 {
   for (auto it = ChildPortsBegin(); it != ChildPortsEnd(); ++it)
@@ -159,18 +305,94 @@ void tPortGroup::DisconnectAll(bool incoming, bool outgoing, tAbstractPort* star
   }
 }
 
-tAbstractPort& tPortGroup::operator[](size_t index)
+void tPortGroup::Freeze()
 {
-  auto it = ChildPortsBegin();
-  for (size_t i = 0; i < index; i++)
+  internal::tStructureLock lock(GetStructureMutex(), "tPortGroup::Freeze");
+  if (frozen_ports.load())
   {
-    ++it;
+    return;
   }
-  if (it == ChildPortsEnd())
+  const tPortTable* table = port_table.load();
+  std::vector<tAbstractPort*>* ports = new std::vector<tAbstractPort*>(table->ports.get(), table->ports.get() + table->size.load());
+  frozen_tables.emplace_back(ports);
+  frozen_ports = ports;
+}
+
+const std::vector<tAbstractPort*>& tPortGroup::GetFrozenPorts() const
+{
+  const std::vector<tAbstractPort*>* ports = frozen_ports.load();
+  if (!ports)
+  {
+    throw std::runtime_error("Port group is not frozen");
+  }
+  return *ports;
+}
+
+size_t tPortGroup::GetPortCount() const
+{
+  return port_table.load(std::memory_order_acquire)->size.load(std::memory_order_acquire);
+}
+
+void tPortGroup::OnChildChange(tFrameworkElement& child, bool added)
+{
+  if (!child.IsPort())
+  {
+    return;
+  }
+  if (frozen_ports.load())
+  {
+    if (added)
+    {
+      FINROC_LOG_PRINT(WARNING, "Port ", child.GetName(), " added to frozen port group. Unfreezing group.");
+    }
+    frozen_ports = NULL;  // frozen table remains valid until group is deleted
+  }
+
+  tAbstractPort* port = &static_cast<tAbstractPort&>(child);
+  tPortTable* table = port_table.load(std::memory_order_relaxed);
+  size_t size = table->size.load(std::memory_order_relaxed);
+  if (added && size < table->capacity)
+  {
+    table->ports[size] = port;
+    table->size.store(size + 1, std::memory_order_release);  // publishes entry
+    return;
+  }
+
+  // copy table (grown - or without removed port)
+  tPortTable* new_table = new tPortTable(added ? table->capacity * 2 : table->capacity);
+  size_t new_size = 0;
+  bool removed = false;
+  for (size_t i = 0; i < size; i++)
+  {
+    if ((!added) && (!removed) && table->ports[i] == port)
+    {
+      removed = true;
+      continue;
+    }
+    new_table->ports[new_size++] = table->ports[i];
+  }
+  if (added)
+  {
+    new_table->ports[new_size++] = port;
+  }
+  else if (!removed)
+  {
+    delete new_table;  // port was not in table
+    return;
+  }
+  new_table->size.store(new_size, std::memory_order_relaxed);
+  port_table.store(new_table, std::memory_order_release);
+  internal::tGarbageDeleter::DeleteDeferred(table);  // table may still be in use by lock-free readers
+}
+
+tAbstractPort& tPortGroup::operator[](size_t index)
+{
+  const tPortTable* table = port_table.load(std::memory_order_acquire);
+  if (index >= table->size.load(std::memory_order_acquire))
   {
     throw std::runtime_error("Out of bounds");
   }
-  return *it;
+  return *table->ports[index];
 }
 
 //----------------------------------------------------------------------
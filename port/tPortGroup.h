@@ -47,6 +47,9 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <vector>
+#include <atomic>
+#include <memory>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -157,6 +160,16 @@ public:
    */
   tAbstractPort* CreatePort(const std::string& name, rrlib::rtti::tType type, tFlags extra_flags = tFlags());
 
+  /*!
+   * Create multiple ports in this group.
+   * More efficient than calling CreatePort() for every port - as the structure lock is acquired once for all ports.
+   *
+   * \param ports Names and data types of ports to create
+   * \param created_ports Contains created ports afterwards (in same order as 'ports'; NULL if port could not be created)
+   * \param extra_flags Any extra flags for ports
+   */
+  void CreatePorts(const std::vector<std::pair<std::string, rrlib::rtti::tType>>& ports, std::vector<tAbstractPort*>& created_ports, tFlags extra_flags = tFlags());
+
   /*!
    * Disconnect all of port group's ports
    *
@@ -180,12 +193,54 @@ public:
   }
 
   /*!
+   * Freezes port group: A copy of the current ports is made available via GetFrozenPorts().
+   * Meant for groups whose ports are fixed after initialization (e.g. IO vectors of modules) - to iterate over ports contiguously.
+   * If ports are added or removed later, the group is unfrozen again (with a warning when ports are added).
+   * May be called again after group has been unfrozen.
+   */
+  void Freeze();
+
+  /*!
+   * \return Ports of this group when it was frozen - in the same order as with operator[]
+   * (The returned vector is never modified and remains valid as long as this port group exists -
+   *  also if the group is unfrozen. It is not updated then, however.)
+   * \exception Throws std::runtime_error if port group is not frozen
+   */
+  const std::vector<tAbstractPort*>& GetFrozenPorts() const;
+
+  /*!
+   * (does not acquire any lock)
+   *
+   * \return Number of ports in this group
+   */
+  size_t GetPortCount() const;
+
+  /*!
+   * \return Has port group been frozen? (see Freeze())
+   */
+  bool IsFrozen() const
+  {
+    return frozen_ports.load() != NULL;
+  }
+
+  /*!
+   * Ports are indexed in the order in which they were added to this group
+   * (this is the order of iterating over child ports - unless ports were removed before others were added).
+   * Does not acquire any lock.
+   *
    * \param index of port in this group
    * \return nth Port in this port group
-   * \exception Throws std::runtime_error if index is out of bounds (use ChildCount() to check for number of children)
+   * \exception Throws std::runtime_error if index is out of bounds (use GetPortCount() to check for number of ports)
    */
   tAbstractPort& operator[](size_t index);
 
+//----------------------------------------------------------------------
+// Protected methods
+//----------------------------------------------------------------------
+protected:
+
+  virtual ~tPortGroup();
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -194,6 +249,37 @@ private:
   /*! Default flags for any ports to be created in this Group */
   tFlags default_port_flags;
 
+  /*! Table with ports of this group (see port_table) */
+  struct tPortTable;
+
+  /*!
+   * Ports in this group - in the order in which they were added.
+   * Maintained incrementally (with structure lock acquired) - and read without lock:
+   * Added ports are appended in place. A table is replaced by a copy when it is full - or when a port is removed.
+   * Replaced tables are deleted via garbage deleter. Never NULL.
+   */
+  std::atomic<tPortTable*> port_table;
+
+  /*! Ports when group was frozen - NULL if group is not frozen (see Freeze()) */
+  std::atomic<const std::vector<tAbstractPort*>*> frozen_ports;
+
+  /*! All tables that were created by Freeze() - kept until group is deleted (so that references returned by GetFrozenPorts() remain valid) */
+  std::vector<std::unique_ptr<const std::vector<tAbstractPort*>>> frozen_tables;
+
+  /*!
+   * Connects ports to ports with the same name in other port group
+   * (sorts ports of both groups by name and merge-joins them; all connections are created in one batch)
+   *
+   * \param other_group Partner port group
+   * \param ports Ports in this group to connect
+   * \param create_missing_ports Create ports in other group, if it has no ports with the names of some ports to connect
+   * \param port_prefix Prefix of ports in this group. Prefix is cut off when comparing names.
+   * \param other_port_prefix Prefix of ports in other group to ignore. This is prepended when ports are created.
+   */
+  void ConnectByNameImpl(tPortGroup& other_group, const std::vector<tAbstractPort*>& ports, bool create_missing_ports, const std::string& port_prefix, const std::string& other_port_prefix);
+
+  virtual void OnChildChange(tFrameworkElement& child, bool added) override;
+
 };
 
 //----------------------------------------------------------------------
@@ -33,15 +33,21 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/thread/tThread.h"
+#include <array>
+#include <functional>
 #include <sstream>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "core/tFrameworkElementTags.h"
+#include "core/tLockOrderLevel.h"
 #include "core/tRuntimeEnvironment.h"
 #include "core/tRuntimeSettings.h"
+#include "core/internal/tChildNameIndex.h"
 #include "core/internal/tGarbageDeleter.h"
+#include "core/internal/tNamePool.h"
+#include "core/internal/tStructureLock.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -70,8 +76,6 @@ typedef rrlib::thread::tLock tLock;
 //----------------------------------------------------------------------
 constexpr tFrameworkElementFlags tFrameworkElement::cSTATUS_FLAGS;
 
-const std::string cUNNAMED_ELEMENT_STRING("(Unnamed Framework Element)");
-const std::string cDELETED_ELEMENT_STRING("(Deleted Framework Element)");
 
 /*! Maximum depth of framework element hierarchy (introduced so that accidental recursive instantiation does not lead to infinite loops and application hangups) */
 const size_t MAX_HIERARCHY_DEPTH = 100;
@@ -80,22 +84,84 @@ const size_t MAX_HIERARCHY_DEPTH = 100;
 // Implementation
 //----------------------------------------------------------------------
 tFrameworkElement::tChildSet tFrameworkElement::empty_child_set;
+std::atomic<uint64_t> tFrameworkElement::naming_stamp_counter(0);
 
-namespace internal
+struct tFrameworkElement::tQualifiedNames
 {
+  /*! Qualified name */
+  tString name;
+
+  /*! Qualified link */
+  tString link;
+
+  /*! Is qualified link globally unique? */
+  bool globally_unique_link;
+
+  /*! True if names belong to a ready element with ready parents (such names only change on deletion) - set with structure mutex */
+  mutable std::atomic<bool> final;
+
+  /*! Value of naming_stamp_counter when names were computed */
+  uint64_t computed_stamp;
+};
+
+/*!
+ * \return Name of unnamed framework elements (interned on first use - as elements might be constructed during static initialization)
+ */
+static const tString& UnnamedElementName()
+{
+  static const tString& name = internal::tNamePool::Intern("(Unnamed Framework Element)");
+  return name;
+}
 
 /*!
- * Annotation that is created if additional string buffers are needed to
- * store a framework element's name in a thread-safe way.
+ * \return Name of deleted framework elements (interned)
  */
-class tStringBufferAnnotation : public tAnnotation
+static const tString& DeletedElementName()
 {
-public:
+  static const tString& name = internal::tNamePool::Intern("(Deleted Framework Element)");
+  return name;
+}
+
+/*!
+ * Releases name of link
+ * (names of unnamed and deleted elements are interned permanently - so they are not released)
+ *
+ * \param name Name to release
+ */
+static void ReleaseName(const tString* name)
+{
+  if (name != &UnnamedElementName() && name != &DeletedElementName())
+  {
+    internal::tNamePool::Release(name);
+  }
+}
 
-  /*! Additional string buffer */
-  tString string_buffer;
+namespace
+{
+
+/*! Number of child set lock domains (power of two) */
+enum { cCHILD_SET_LOCK_DOMAINS = 64 };
+
+/*! Lock domain that guards the child sets of a subset of framework elements */
+struct tChildSetLockDomain
+{
+  /*! Mutex of domain */
+  rrlib::thread::tOrderedMutex mutex;
+
+  tChildSetLockDomain() :
+    mutex("Child Set", static_cast<int>(tLockOrderLevel::CHILD_SET))
+  {}
 };
 
+/*!
+ * \return Child set lock domains (never deleted - elements may be deleted during static destruction)
+ */
+std::array<tChildSetLockDomain, cCHILD_SET_LOCK_DOMAINS>& ChildSetLockDomains()
+{
+  static std::array<tChildSetLockDomain, cCHILD_SET_LOCK_DOMAINS>* domains = new std::array<tChildSetLockDomain, cCHILD_SET_LOCK_DOMAINS>();
+  return *domains;
+}
+
 }
 
 tFrameworkElement::tFrameworkElement(tFrameworkElement* parent, const tString& name, tFlags flags) :
@@ -105,17 +171,22 @@ tFrameworkElement::tFrameworkElement(tFrameworkElement* parent, const tString& n
   creater_thread_uid(rrlib::thread::tThread::CurrentThreadId()),
 #endif
   flags(flags),
-  children(flags.Get(tFlag::PORT) ? &empty_child_set : new tChildSet())
+  children(flags.Get(tFlag::PORT) ? &empty_child_set : new tChildSet()),
+  child_link_count(0),
+  child_name_index(NULL)
 {
   if (flags.Raw() & cSTATUS_FLAGS.Raw())
   {
     FINROC_LOG_PRINT(ERROR, "No status flags may be set in constructor");
     abort();
   }
+  if (!IsRuntime())
+  {
+    GetRuntime().elements.UpdateFlags(handle, flags);
+  }
   if (name.length() > 0)
   {
-    primary.name_buffer = name;
-    primary.name = &primary.name_buffer;
+    primary.name = &internal::tNamePool::Intern(name);
   }
 
   if (!IsRuntime())
@@ -140,7 +211,7 @@ tFrameworkElement::~tFrameworkElement()
   if (!IsRuntime())
   {
     // synchronizes on runtime - to ensure that no elements (e.g. this one) are deleted while possibly someone else has runtime locked
-    rrlib::thread::tLock lock(GetStructureMutex());
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::~tFrameworkElement");
     //GetRuntime().UnregisterElement(*this);
   }
 
@@ -158,6 +229,7 @@ tFrameworkElement::~tFrameworkElement()
   {
     delete children;
   }
+  delete child_name_index;
 }
 
 void tFrameworkElement::AddChild(tLink& child)
@@ -189,12 +261,12 @@ void tFrameworkElement::AddChild(tLink& child)
   }
 
   // lock runtime (required to perform structural changes)
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::AddChild");
 
   // perform checks
   assert(child.GetChild().IsConstructing() && "tree structure is fixed for initialized children - is child initialized twice (?)");
   assert(child.GetChild().IsCreator() && "may only be called by child creator thread");
-  if (IsDeleted() || (child.parent && child.parent->IsDeleted()) || child.GetChild().IsDeleted())
+  if (IsDeleted() || (child.parent && child.GetParent()->IsDeleted()) || child.GetChild().IsDeleted())
   {
     throw std::runtime_error("Child to add has been deleted or has deleted parent.");
   }
@@ -207,7 +279,17 @@ void tFrameworkElement::AddChild(tLink& child)
   if (child.parent)
   {
     //assert(!child.parent.isInitialized()) : "This is truly strange - should not happen";
-    child.parent->children->Remove(&child);
+    {
+      tLock lock2(child.GetParent()->GetChildSetMutex());
+      if (child.GetParent()->child_name_index)
+      {
+        child.GetParent()->child_name_index->Remove(child);
+      }
+      child.GetParent()->children->Remove(&child);
+      child.GetParent()->child_link_count--;
+    }
+    child.GetParent()->OnChildChange(child.GetChild(), false);
+    child.parent.store(NULL, std::memory_order_release);
   }
 
   // Check if child with same name already exists and possibly rename?
@@ -224,8 +306,22 @@ void tFrameworkElement::AddChild(tLink& child)
     }
   }
 
-  child.parent = this;
-  children->Add(&child);
+  {
+    tLock lock2(GetChildSetMutex());
+    child.parent.store(this, std::memory_order_release);
+    NameChanged(child);
+    children->Add(&child);
+    child_link_count++;
+    if (child_name_index)
+    {
+      child_name_index->Add(child);
+    }
+  }
+  OnChildChange(child.GetChild(), true);
+  if (child.IsPrimaryLink())
+  {
+    GetRuntime().elements.UpdateParent(child.GetChild().GetHandle(), GetHandle());
+  }
   // child.init(); - do this separately
 }
 
@@ -278,9 +374,40 @@ void tFrameworkElement::CheckForNameClash(const tLink& link) const
 {
   if (!tRuntimeSettings::DuplicateQualifiedNamesAllowed() && link.parent && (!link.GetChild().GetFlag(tFlag::NETWORK_ELEMENT))) // we cannot influence naming of elements in other runtime environments
   {
-    for (auto it = link.parent->ChildrenBegin(); it != link.parent->ChildrenEnd(); ++it)
+    bool indexed = false;
+    const tLink* clash = NULL;
+    {
+      tLock lock(link.GetParent()->GetChildSetMutex());
+      internal::tChildNameIndex* index = link.GetParent()->GetChildNameIndex();
+      if (index)
+      {
+        indexed = true;
+        auto range = index->Find(link.GetName());
+        for (auto it = range.first; it != range.second && (!clash); ++it)
+        {
+          if (it->second != &link && it->second->GetChild().IsReady())
+          {
+            clash = it->second;
+          }
+        }
+      }
+    }
+    if (clash)  // reported without child set mutex - as GetQualifiedName() acquires structure mutex
     {
-      if (it->IsReady() && it->GetName().compare(primary.GetName()) == 0)
+      FINROC_LOG_PRINT(ERROR, "Framework elements with the same qualified names are not allowed ('", clash->GetChild().GetQualifiedName(),
+                       "'), since this causes undefined behavior with port connections by qualified names (e.g. in fingui or in finstructable groups). Apart from manually choosing another name, there are two ways to solve this:\n",
+                       "  1) Set the tFrameworkElementFlags::AUTO_RENAME flag when constructing parent framework element.\n",
+                       "  2) Explicitly allow duplicate names by calling tRuntimeSettings::AllowDuplicateQualifiedNames() and be careful.");
+      abort();
+    }
+    if (indexed)
+    {
+      return;
+    }
+
+    for (auto it = link.GetParent()->ChildrenBegin(); it != link.GetParent()->ChildrenEnd(); ++it)
+    {
+      if (it->IsReady() && &it->GetName() == &primary.GetName())
       {
         FINROC_LOG_PRINT(ERROR, "Framework elements with the same qualified names are not allowed ('", it->GetQualifiedName(),
                          "'), since this causes undefined behavior with port connections by qualified names (e.g. in fingui or in finstructable groups). Apart from manually choosing another name, there are two ways to solve this:\n",
@@ -292,16 +419,6 @@ void tFrameworkElement::CheckForNameClash(const tLink& link) const
   }
 }
 
-size_t tFrameworkElement::ChildCount() const
-{
-  size_t count = 0;
-  for (auto it = ChildrenBegin(); it != ChildrenEnd(); ++it)
-  {
-    count++;
-  }
-  return count;
-}
-
 void tFrameworkElement::DeleteChildren()
 {
   for (auto it = children->Begin(); it != children->End(); ++it)
@@ -310,12 +427,42 @@ void tFrameworkElement::DeleteChildren()
     child->GetChild().ManagedDelete(child);
   }
 
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::DeleteChildren");
+  for (auto it = children->Begin(); it != children->End(); ++it)
+  {
+    OnChildChange((*it)->GetChild(), false);
+  }
+  tLock lock2(GetChildSetMutex());
   children->Clear();
+  child_link_count = 0;
+  delete child_name_index;
+  child_name_index = NULL;
 }
 
 tFrameworkElement* tFrameworkElement::GetChild(const tString& name) const
 {
+  if (UsesChildNameIndex())
+  {
+    tLock lock(GetChildSetMutex());  // child set mutex suffices - so lookups do not contend with structural changes in other subtrees
+    if (IsDeleted())
+    {
+      return NULL;
+    }
+    internal::tChildNameIndex* index = GetChildNameIndex();
+    if (index)
+    {
+      auto range = index->Find(name);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        if (!it->second->GetChild().IsDeleted())
+        {
+          return &it->second->GetChild();
+        }
+      }
+      return NULL;
+    }
+  }
+
   for (auto it = children->Begin(); it != children->End(); ++it)
   {
     if ((*it)->GetChild().IsReady())
@@ -327,7 +474,7 @@ tFrameworkElement* tFrameworkElement::GetChild(const tString& name) const
     }
     else
     {
-      tLock lock(GetStructureMutex());
+      tLock lock(GetChildSetMutex());
       if (IsDeleted())
       {
         return NULL;
@@ -352,8 +499,19 @@ tFrameworkElement* tFrameworkElement::GetChildElement(const tString& name, bool
 
 tFrameworkElement* tFrameworkElement::GetChildElement(const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root)
 {
+  // Structure of ready elements is fixed - so we try without locking first
+  if (IsReady() && (name[name_index] != '/' || root.IsReady()))
+  {
+    bool complete = true;
+    tFrameworkElement* result = GetReadyChildElement(name, name_index, only_globally_unique_children, root, complete);
+    if (result || complete)
+    {
+      return result;
+    }
+  }
+
   // lock runtime (might not be absolutely necessary... ensures, however, that result is valid)
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetChildElement");
 
   if (IsDeleted())
   {
@@ -366,10 +524,163 @@ tFrameworkElement* tFrameworkElement::GetChildElement(const tString& name, int n
   }
 
   only_globally_unique_children &= (!GetFlag(tFlag::GLOBALLY_UNIQUE_LINK));
+  if (UsesChildNameIndex())
+  {
+    // links may contain '/' - so every part of the name that ends before a '/' (or at the end) is a candidate child name
+    bool indexed = true;
+    for (size_t end = name.find('/', name_index); indexed; end = name.find('/', end + 1))
+    {
+      size_t child_name_length = (end == tString::npos ? name.length() : end) - name_index;
+      tLink* child = NULL;
+      for (size_t i = 0; (child = GetIndexedChildLink(name, name_index, child_name_length, i, indexed)) != NULL; i++)
+      {
+        tFrameworkElement* result = GetChildElementHelper(*child, name, name_index, only_globally_unique_children, root);
+        if (result)
+        {
+          return result;
+        }
+      }
+      if (indexed && end == tString::npos)
+      {
+        return NULL;
+      }
+    }
+  }
+
   for (auto it = children->Begin(); it != children->End(); ++it)
   {
     tLink* child = &(**it);
     if (name.compare(name_index, child->name->length(), *(child->name)) == 0 && (!child->GetChild().IsDeleted()))
+    {
+      tFrameworkElement* result = GetChildElementHelper(*child, name, name_index, only_globally_unique_children, root);
+      if (result)
+      {
+        return result;
+      }
+      // continue, because links may contain '/'... (this is slightly ugly... better solution? TODO)
+    }
+  }
+  return NULL;
+}
+
+tFrameworkElement* tFrameworkElement::GetChildElementHelper(tLink& child, const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root)
+{
+  if (name.length() == name_index + child.name->length())
+  {
+    if (!only_globally_unique_children || child.GetChild().GetFlag(tFlag::GLOBALLY_UNIQUE_LINK))
+    {
+      return &child.GetChild();
+    }
+  }
+  if (name[name_index + child.name->length()] == '/')
+  {
+    return child.GetChild().GetChildElement(name, name_index + child.name->length() + 1, only_globally_unique_children, root);
+  }
+  return NULL;
+}
+
+rrlib::thread::tOrderedMutex& tFrameworkElement::GetChildSetMutex() const
+{
+  return ChildSetLockDomains()[(std::hash<const void*>()(this) >> 6) & (cCHILD_SET_LOCK_DOMAINS - 1)].mutex;  // distributed by address - so lookups in unrelated subtrees rarely share a mutex
+}
+
+tFrameworkElement::tLink* tFrameworkElement::GetIndexedChildLink(const tString& name, size_t name_index, size_t name_length, size_t candidate_index, bool& indexed) const
+{
+  tLock lock(GetChildSetMutex());  // released before caller descends - child set mutexes are not nested
+  internal::tChildNameIndex* index = GetChildNameIndex();
+  if (!index)
+  {
+    indexed = false;
+    return NULL;
+  }
+  auto range = index->Find(name, name_index, name_length);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if ((!it->second->GetChild().IsDeleted()) && candidate_index-- == 0)
+    {
+      return it->second;
+    }
+  }
+  return NULL;
+}
+
+internal::tChildNameIndex* tFrameworkElement::GetChildNameIndex() const
+{
+  if ((!child_name_index) && UsesChildNameIndex())
+  {
+    child_name_index = new internal::tChildNameIndex();
+    for (auto it = children->Begin(); it != children->End(); ++it)
+    {
+      child_name_index->Add(**it);
+    }
+  }
+  return child_name_index;
+}
+
+tFrameworkElement* tFrameworkElement::GetReadyChildElement(const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root, bool& complete)
+{
+  if (name[name_index] == '/')
+  {
+    if (!root.IsReady())
+    {
+      complete = false;
+      return NULL;
+    }
+    return root.GetReadyChildElement(name, name_index + 1, only_globally_unique_children, root, complete);
+  }
+  only_globally_unique_children &= (!GetFlag(tFlag::GLOBALLY_UNIQUE_LINK));
+  if (UsesChildNameIndex())
+  {
+    // links may contain '/' - so every part of the name that ends before a '/' (or at the end) is a candidate child name
+    for (size_t end = name.find('/', name_index); ; end = name.find('/', end + 1))
+    {
+      size_t child_name_length = (end == tString::npos ? name.length() : end) - name_index;
+      bool indexed = true;
+      tLink* child = NULL;
+      for (size_t i = 0; (child = GetIndexedChildLink(name, name_index, child_name_length, i, indexed)) != NULL; i++)
+      {
+        if (!child->GetChild().IsReady())
+        {
+          complete = false;  // deleted children are not returned by GetIndexedChildLink()
+          continue;
+        }
+        if (end == tString::npos)
+        {
+          if (!only_globally_unique_children || child->GetChild().GetFlag(tFlag::GLOBALLY_UNIQUE_LINK))
+          {
+            return &child->GetChild();
+          }
+        }
+        else
+        {
+          tFrameworkElement* result = child->GetChild().GetReadyChildElement(name, end + 1, only_globally_unique_children, root, complete);
+          if (result)
+          {
+            return result;
+          }
+        }
+      }
+      if (!indexed)
+      {
+        complete = false;  // number of children dropped concurrently before index was created
+        return NULL;
+      }
+      if (end == tString::npos)
+      {
+        return NULL;
+      }
+    }
+  }
+
+  for (auto it = children->Begin(); it != children->End(); ++it)
+  {
+    tLink* child = &(**it);
+    if (!child->GetChild().IsReady())
+    {
+      complete &= child->GetChild().IsDeleted();
+      continue;
+    }
+    if (name.compare(name_index, child->name->length(), *(child->name)) == 0)
     {
       if (name.length() == name_index + child->name->length())
       {
@@ -380,12 +691,11 @@ tFrameworkElement* tFrameworkElement::GetChildElement(const tString& name, int n
       }
       if (name[name_index + child->name->length()] == '/')
       {
-        tFrameworkElement* result = child->GetChild().GetChildElement(name, name_index + child->name->length() + 1, only_globally_unique_children, root);
+        tFrameworkElement* result = child->GetChild().GetReadyChildElement(name, name_index + child->name->length() + 1, only_globally_unique_children, root, complete);
         if (result)
         {
           return result;
         }
-        // continue, because links may contain '/'... (this is slightly ugly... better solution? TODO)
       }
     }
   }
@@ -394,32 +704,32 @@ tFrameworkElement* tFrameworkElement::GetChildElement(const tString& name, int n
 
 const tFrameworkElement::tLink* tFrameworkElement::GetLink(size_t link_index) const
 {
-  tLock lock(GetStructureMutex());  // absolutely safe this way
-  if (IsDeleted())
+  if (IsReady())
   {
-    return NULL;
+    const tLink* link = GetLinkHelper(link_index);  // links of ready elements do not change (see Link())
+    return IsDeleted() ? NULL : link;  // element might have been deleted concurrently
   }
-  const tLink* l = &(primary);
-  for (size_t i = 0u; i < link_index; i++)
+  else
   {
-    l = l->next;
-    if (l == NULL)
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetLink");  // absolutely safe this way
+    if (IsDeleted())
     {
       return NULL;
     }
+    return GetLinkHelper(link_index);
   }
-  return l;
 }
 
 size_t tFrameworkElement::GetLinkCount() const
 {
   if (IsReady())
   {
-    return GetLinkCountHelper();
+    size_t count = GetLinkCountHelper();
+    return IsDeleted() ? 0u : count;  // element might have been deleted concurrently
   }
   else
   {
-    tLock lock(GetStructureMutex());  // absolutely safe this way
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetLinkCount");  // absolutely safe this way
     return GetLinkCountHelper();
   }
 }
@@ -431,13 +741,27 @@ size_t tFrameworkElement::GetLinkCountHelper() const
     return 0u;
   }
   size_t i = 0u;
-  for (const tLink* l = &(primary); l != NULL; l = l->next)
+  for (const tLink* l = &(primary); l != NULL; l = l->next.load(std::memory_order_acquire))
   {
     i++;
   }
   return i;
 }
 
+const tFrameworkElement::tLink* tFrameworkElement::GetLinkHelper(size_t link_index) const
+{
+  const tLink* l = &(primary);
+  for (size_t i = 0u; i < link_index; i++)
+  {
+    l = l->next.load(std::memory_order_acquire);
+    if (l == NULL)
+    {
+      return NULL;
+    }
+  }
+  return l;
+}
+
 tFrameworkElement::tLink* tFrameworkElement::GetLinkInternal(size_t link_index)
 {
   tLink* l = &(primary);
@@ -454,67 +778,141 @@ tFrameworkElement::tLink* tFrameworkElement::GetLinkInternal(size_t link_index)
 
 void tFrameworkElement::GetNameHelper(tString& sb, const tLink& l, bool abort_at_link_root)
 {
-  if (l.parent == NULL || (abort_at_link_root && l.GetChild().GetFlag(tFlag::ALTERNATIVE_LINK_ROOT)))    // runtime?
+  if (l.GetParent() == NULL || (abort_at_link_root && l.GetChild().GetFlag(tFlag::ALTERNATIVE_LINK_ROOT)))    // runtime?
   {
     return;
   }
-  GetNameHelper(sb, l.parent->primary, abort_at_link_root);
+  GetNameHelper(sb, l.GetParent()->primary, abort_at_link_root);
   sb.append("/");
   sb.append(*(l.name));
 }
 
 tFrameworkElement* tFrameworkElement::GetParent(int link_index) const
 {
-  tLock lock(GetStructureMutex());  // absolutely safe this way
-  if (IsDeleted())
+  if (IsReady())
   {
-    return NULL;
+    const tLink* link = GetLinkHelper(link_index);  // links of ready elements do not change (see Link())
+    tFrameworkElement* parent = link ? link->GetParent() : NULL;
+    return IsDeleted() ? NULL : parent;  // parent is cleared in ManagedDelete() after DELETED is set
+  }
+  else
+  {
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetParent");  // absolutely safe this way
+    if (IsDeleted())
+    {
+      return NULL;
+    }
+    const tLink* link = GetLinkHelper(link_index);
+    return link ? link->GetParent() : NULL;
   }
-  return GetLink(link_index)->parent;
 }
 
 tFrameworkElement* tFrameworkElement::GetParentWithFlags(tFlags parent_flags) const
 {
-  if (primary.parent == NULL)
+  if (primary.GetParent() == NULL)
   {
     return NULL;
   }
-  tLock lock(GetStructureMutex());  // not really necessary after element has been initialized
-  if (IsDeleted())
+  if (IsReady())
   {
-    return NULL;
+    tFrameworkElement* result = GetParentWithFlagsHelper(parent_flags);  // parents of initialized elements do not change
+    return IsDeleted() ? NULL : result;  // element might have been deleted concurrently
+  }
+  else
+  {
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetParentWithFlags");
+    if (IsDeleted())
+    {
+      return NULL;
+    }
+    return GetParentWithFlagsHelper(parent_flags);
   }
+}
 
-  tFrameworkElement* result = primary.parent;
-  while (!((result->GetAllFlags().Raw() & parent_flags.Raw()) == parent_flags.Raw()))
+tFrameworkElement* tFrameworkElement::GetParentWithFlagsHelper(tFlags parent_flags) const
+{
+  // every parent pointer is read only once and checked before it is dereferenced (may be cleared concurrently by ManagedDelete() if no lock is held)
+  for (tFrameworkElement* result = primary.GetParent(); result; result = result->primary.GetParent())
   {
-    result = result->primary.parent;
-    if (result == NULL || result->IsDeleted())
+    if (result->IsDeleted())
     {
-      break;
+      return NULL;  // hierarchy is being deleted concurrently
+    }
+    if ((result->GetAllFlags().Raw() & parent_flags.Raw()) == parent_flags.Raw())
+    {
+      return result;
     }
   }
-  return result;
+  return NULL;
 }
 
 bool tFrameworkElement::GetQualifiedName(tString& sb, const tLink& start, bool force_full_link) const
 {
-  if (IsReady())
+  const tQualifiedNames& names = GetQualifiedNames(start);
+  sb = force_full_link ? names.name : names.link;  // reuses buffer
+  return (!force_full_link) && names.globally_unique_link;
+}
+
+const tString& tFrameworkElement::GetQualifiedLinkReference(size_t link_index) const
+{
+  const tLink* link = GetLink(link_index);
+  assert(link);
+  return GetQualifiedNames(*link).link;
+}
+
+const tString& tFrameworkElement::GetQualifiedNameReference(size_t link_index) const
+{
+  const tLink* link = GetLink(link_index);
+  assert(link);
+  return GetQualifiedNames(*link).name;
+}
+
+const tFrameworkElement::tQualifiedNames& tFrameworkElement::GetQualifiedNames(const tLink& link) const
+{
+  const tQualifiedNames* names = link.qualified_names.load();
+  if (names && names->final)
   {
-    return GetQualifiedNameImpl(sb, start, force_full_link);
+    return *names;
   }
-  else
+
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::GetQualifiedNames");  // synchronize while element is under construction
+  names = link.qualified_names.load();
+  bool valid = names != NULL;
+  for (const tLink* l = &link; valid && l; l = l->GetParent() ? &(l->GetParent()->primary) : NULL)  // has any link on path to root changed?
+  {
+    valid = l->naming_stamp <= names->computed_stamp;
+  }
+  bool final = IsReady();
+  for (const tLink* l = &link; final && l->GetParent(); l = &(l->GetParent()->primary))  // ready elements can neither be renamed nor relinked
+  {
+    final = l->GetParent()->IsReady();
+  }
+  if (valid)
   {
-    tLock lock(GetStructureMutex());  // synchronize while element is under construction
-    return GetQualifiedNameImpl(sb, start, force_full_link);
+    if (final)
+    {
+      names->final = true;
+    }
+    return *names;
   }
+  tQualifiedNames* new_names = new tQualifiedNames();
+  GetQualifiedNameImpl(new_names->name, link, true);
+  new_names->globally_unique_link = GetQualifiedNameImpl(new_names->link, link, false);
+  new_names->final = final;
+  new_names->computed_stamp = naming_stamp_counter.load();
+  link.qualified_names = new_names;
+  if (names)
+  {
+    internal::tGarbageDeleter::DeleteDeferred(const_cast<tQualifiedNames*>(names));  // references to old names might still be in use
+  }
+  return *new_names;
 }
 
 bool tFrameworkElement::GetQualifiedNameImpl(tString& sb, const tLink& start, bool force_full_link) const
 {
   size_t length = 0u;
   bool abort_at_link_root = false;
-  for (const tLink* l = &start; l->parent != NULL && !(abort_at_link_root && l->GetChild().GetFlag(tFlag::ALTERNATIVE_LINK_ROOT)); l = &(l->parent->primary))
+  for (const tLink* l = &start; l->GetParent() != NULL && !(abort_at_link_root && l->GetChild().GetFlag(tFlag::ALTERNATIVE_LINK_ROOT)); l = &(l->GetParent()->primary))
   {
     abort_at_link_root |= (!force_full_link) && l->GetChild().GetFlag(tFlag::GLOBALLY_UNIQUE_LINK);
     if (abort_at_link_root && l->GetChild().GetFlag(tFlag::ALTERNATIVE_LINK_ROOT))    // if unique_link element is at the same time a link root
@@ -552,7 +950,7 @@ rrlib::thread::tRecursiveMutex& tFrameworkElement::GetStructureMutex() const
 
 void tFrameworkElement::Init()
 {
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::Init");
   //SimpleList<FrameworkElement> publishThese = new SimpleList<FrameworkElement>();
   // assert(getFlag(CoreFlags.IS_RUNTIME) || getParent().isReady());
   if (IsDeleted())
@@ -571,7 +969,18 @@ void tFrameworkElement::Init()
 
 void tFrameworkElement::InitAll()
 {
-  GetRuntime().Init();
+  tRuntimeEnvironment& runtime = GetRuntime();
+  runtime.BeginDeferredLinkResolution();
+  try
+  {
+    runtime.Init();
+  }
+  catch (...)
+  {
+    runtime.EndDeferredLinkResolution();
+    throw;
+  }
+  runtime.EndDeferredLinkResolution();
 }
 
 void tFrameworkElement::InitiallyShowInTools(int32_t priority)
@@ -633,6 +1042,10 @@ void tFrameworkElement::InitImplementation()
       //tLock lock(*this); // we have structure lock
       flags |= tFlag::READY;
     }
+    if (!IsRuntime())
+    {
+      GetRuntime().elements.UpdateFlags(handle, flags);
+    }
 
     NotifyAnnotationsInitialized();
   }
@@ -640,11 +1053,23 @@ void tFrameworkElement::InitImplementation()
 
 bool tFrameworkElement::IsChildOf(const tFrameworkElement& re, bool ignore_delete_flag) const
 {
-  tLock lock(GetStructureMutex());  // absolutely safe this way
-  if ((!ignore_delete_flag) && IsDeleted())
+  if (IsReady())
   {
-    return false;
+    return IsChildOfHelper(re, ignore_delete_flag);  // links of ready elements do not change
+  }
+  else
+  {
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::IsChildOf");  // absolutely safe this way
+    if ((!ignore_delete_flag) && IsDeleted())
+    {
+      return false;
+    }
+    return IsChildOfHelper(re, ignore_delete_flag);
   }
+}
+
+bool tFrameworkElement::IsChildOfHelper(const tFrameworkElement& re, bool ignore_delete_flag) const
+{
   for (const tLink* l = &(primary); l != NULL; l = l->next)
   {
     if (l->parent == &re)
@@ -657,7 +1082,7 @@ bool tFrameworkElement::IsChildOf(const tFrameworkElement& re, bool ignore_delet
     }
     else
     {
-      if (l->parent->IsChildOf(re, ignore_delete_flag))
+      if (l->GetParent()->IsChildOf(re, ignore_delete_flag))
       {
         return true;
       }
@@ -680,11 +1105,16 @@ void tFrameworkElement::Link(tFrameworkElement& parent, const tString& link_name
   assert(IsCreator() && "May only be called by creator thread");
 
   // lock runtime (required to perform structural changes)
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::Link");
   if (IsDeleted() || parent.IsDeleted())
   {
     throw std::runtime_error("Element and/or parent has been deleted.");
   }
+  if (IsReady())
+  {
+    FINROC_LOG_PRINT(ERROR, "Cannot add link to initialized element ", GetQualifiedName());
+    throw std::runtime_error("Cannot add link to initialized element");
+  }
   if (GetLinkCount() >= 127)
   {
     FINROC_LOG_PRINT(ERROR, "Maximum number of links exceeded.");
@@ -692,12 +1122,11 @@ void tFrameworkElement::Link(tFrameworkElement& parent, const tString& link_name
   }
 
   tLink* l = new tLink(*this);
-  l->name_buffer = link_name;
-  l->name = &(l->name_buffer);
-  l->parent = NULL;  // will be set in addChild
+  l->name = &internal::tNamePool::Intern(link_name);
+  l->parent.store(NULL, std::memory_order_relaxed);  // will be set in addChild
   tLink* lprev = GetLinkInternal(GetLinkCount() - 1u);
   assert(lprev->next == NULL);
-  lprev->next = l;
+  lprev->next.store(l, std::memory_order_release);  // link is published to lock-free readers
   CheckForNameClash(*l);
   parent.AddChild(*l);
   //RuntimeEnvironment.getInstance().link(this, linkName);
@@ -707,7 +1136,7 @@ void tFrameworkElement::ManagedDelete(tLink* dont_detach)
 {
   // synchronizes on runtime - so no elements will be deleted while runtime is locked
   {
-    tLock lock4(GetStructureMutex());
+    internal::tStructureLock lock4(GetStructureMutex(), "tFrameworkElement::ManagedDelete");
 
     if (IsDeleted())    // can happen if two threads delete concurrently - no problem, since this is - if at all - called when GarbageCollector-safety period has just started
     {
@@ -726,7 +1155,24 @@ void tFrameworkElement::ManagedDelete(tLink* dont_detach)
     new_flags.Set(tFlag::READY, false);
     for (size_t i = 0; i < this->GetLinkCount(); i++)
     {
-      this->GetLinkInternal(i)->name = &cDELETED_ELEMENT_STRING;
+      tLink* link = this->GetLinkInternal(i);
+      const tString* old_name = link->name;
+      if (link->parent)
+      {
+        tLock lock(link->GetParent()->GetChildSetMutex());
+        if (link != dont_detach && link->GetParent()->child_name_index)
+        {
+          link->GetParent()->child_name_index->Remove(*link);  // before name changes
+        }
+        link->name = &DeletedElementName();
+        NameChanged(*link);
+      }
+      else
+      {
+        link->name = &DeletedElementName();
+        NameChanged(*link);
+      }
+      ReleaseName(old_name);
     }
     flags = new_flags;
 
@@ -749,18 +1195,33 @@ void tFrameworkElement::ManagedDelete(tLink* dont_detach)
     {
       if (l != dont_detach && l->parent != NULL)
       {
-        l->parent->children->Remove(l);
+        {
+          tLock lock(l->GetParent()->GetChildSetMutex());
+          l->GetParent()->children->Remove(l);
+          l->GetParent()->child_link_count--;
+        }
+        l->GetParent()->OnChildChange(*this, false);
       }
       l = l->next;
     }
 
-    primary.parent = NULL;
+    primary.parent.store(NULL, std::memory_order_release);
   }
 
   // add garbage collector task
   internal::tGarbageDeleter::DeleteDeferred(this);
 }
 
+void tFrameworkElement::NameChanged(tLink& link)
+{
+  link.naming_stamp = ++naming_stamp_counter;
+  const tQualifiedNames* names = link.qualified_names.load();
+  if (names)
+  {
+    names->final = false;  // so that GetQualifiedNames() checks naming stamps again (and replaces cache - not done here, as this may be called with child set mutex acquired)
+  }
+}
+
 bool tFrameworkElement::NameEquals(const tString& other) const
 {
   if (IsReady())
@@ -769,7 +1230,7 @@ bool tFrameworkElement::NameEquals(const tString& other) const
   }
   else
   {
-    tLock lock(GetStructureMutex());
+    internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::NameEquals");
     if (IsDeleted())
     {
       return false;
@@ -788,7 +1249,7 @@ void tFrameworkElement::PrintStructure() const
 
 void tFrameworkElement::PrintStructure(int indent, std::stringstream& output) const
 {
-  tLock lock(GetStructureMutex());
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::PrintStructure");
 
   // print element info
   for (int i = 0; i < indent; i++)
@@ -828,6 +1289,10 @@ void tFrameworkElement::SetFlag(tFlag flag, bool value)
 {
   assert(flag >= tFlag::READY || (IsPort() && flag == tFlag::HIJACKED_PORT));
   flags.Set(flag, value);
+  if (!IsRuntime())
+  {
+    GetRuntime().elements.UpdateFlags(handle, flags);
+  }
 }
 
 void tFrameworkElement::SetName(const tString& name)
@@ -848,37 +1313,53 @@ void tFrameworkElement::SetName(const tString& name)
     return;
   }
 
-  internal::tStringBufferAnnotation* string_buffer_annotation = this->GetAnnotation<internal::tStringBufferAnnotation>();
-  if (string_buffer_annotation)
+  const tString& interned_name = internal::tNamePool::Intern(name);  // replaced names are deleted via garbage deleter - so references returned by GetName() remain valid for a while
+  internal::tStructureLock lock(GetStructureMutex(), "tFrameworkElement::SetName");  // synchronize, C++ strings may not be thread safe (e.g. for GetQualifiedName())
+  const tString* old_name = primary.name;
+  if (primary.parent)
   {
-    FINROC_LOG_PRINT(ERROR, "Name may only be changed once. Ignoring.");
-    return;
-  }
-
-  tLock lock(GetStructureMutex());  // synchronize, C++ strings may not be thread safe (e.g. for GetQualifiedName())
-  if (primary.name != &(primary.name_buffer))
-  {
-    primary.name_buffer = name;
-    primary.name = &(primary.name_buffer);
+    tLock lock2(primary.GetParent()->GetChildSetMutex());  // name is looked up by GetChild() on parent
+    internal::tChildNameIndex* parent_index = primary.GetParent()->child_name_index;
+    if (parent_index)
+    {
+      parent_index->Remove(primary);
+    }
+    primary.name = &interned_name;
+    NameChanged(primary);
+    if (parent_index)
+    {
+      parent_index->Add(primary);
+    }
   }
   else
   {
-    FINROC_LOG_PRINT(DEBUG, "Creating another string buffer for name change to '", name, "'.");
-    string_buffer_annotation = &EmplaceAnnotation<internal::tStringBufferAnnotation>();
-    string_buffer_annotation->string_buffer = name;
-    primary.name = &(string_buffer_annotation->string_buffer);
+    primary.name = &interned_name;
+    NameChanged(primary);
   }
+  ReleaseName(old_name);
 
 }
 
+bool tFrameworkElement::UsesChildNameIndex() const
+{
+  return child_link_count.load() >= internal::tChildNameIndex::cMIN_CHILD_COUNT;
+}
+
 tFrameworkElement::tLink::tLink(tFrameworkElement& pointed_to) :
   points_to(pointed_to),
-  name(&cUNNAMED_ELEMENT_STRING),
-  name_buffer(),
+  name(&UnnamedElementName()),
   parent(NULL),
-  next(NULL)
+  next(NULL),
+  qualified_names(NULL),
+  naming_stamp(0)
 {}
 
+tFrameworkElement::tLink::~tLink()
+{
+  delete qualified_names.load();
+  ReleaseName(name);
+}
+
 tFrameworkElement::tSubElementIterator::tSubElementIterator(tFrameworkElement& framework_element, bool include_root) :
   current_depth(0),
   at_root(include_root ? &framework_element : NULL)
@@ -43,6 +43,7 @@
 //----------------------------------------------------------------------
 #include "rrlib/concurrent_containers/tSet.h"
 #include "rrlib/thread/tLock.h"
+#include <atomic>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -73,6 +74,7 @@ class tAbstractPort;
 class tRuntimeEnvironment;
 namespace internal
 {
+class tChildNameIndex;
 class tGarbageDeleter;
 }
 
@@ -117,6 +119,9 @@ public:
 
 private:
 
+  /*! Qualified name and link of a link (cached - see GetQualifiedNames()) */
+  struct tQualifiedNames;
+
   /*! Type of child list */
   typedef rrlib::concurrent_containers::tSet < tLink*, rrlib::concurrent_containers::tAllowDuplicates::NO, rrlib::thread::tNoMutex,
           rrlib::concurrent_containers::set::storage::ArrayChunkBased<8, 19, definitions::cSINGLE_THREADED >> tChildSet;
@@ -147,7 +152,7 @@ public:
 
   typedef tFrameworkElementFlag tFlag;
   typedef tFrameworkElementFlags tFlags;
-  typedef uint32_t tHandle;
+  typedef definitions::tHandle tHandle;
 
   // Iterator types
   class tChildIterator;
@@ -179,11 +184,12 @@ public:
   }
 
   /*!
-   * (implementation note: uses tChildIterator to determine the number of children)
-   *
    * \return Number of child elements of this framework element.
    */
-  size_t ChildCount() const;
+  size_t ChildCount() const
+  {
+    return child_link_count.load();
+  }
 
   /*!
    * \return An iterator to iterate over this node's child ports. Initially points to the first port.
@@ -299,8 +305,9 @@ public:
    * \return Name of this framework element
    *
    * (Calling this function is non-blocking and thread-safe.
-   *  Working with the returned string reference is thread-safe as well - until framework element is completely deleted.
-   *  The referenced string will not change when the name of the framework element is changed.)
+   *  Working with the returned string reference is thread-safe as well - even after framework element has been deleted.
+   *  The referenced string will not change when the name of the framework element is changed.
+   *  It is interned (see internal::tNamePool) - so names of two elements are equal if and only if the addresses of their names are equal.)
    */
   const tString& GetName() const
   {
@@ -312,7 +319,7 @@ public:
    */
   inline tFrameworkElement* GetParent() const
   {
-    return primary.parent;
+    return primary.GetParent();
   }
 
   /*!
@@ -330,7 +337,7 @@ public:
   tFrameworkElement* GetParentWithFlags(tFlags parent_flags) const;
 
   /*!
-   * (Use StringBuilder version if efficiency or real-time is an issue)
+   * (Use GetQualifiedLinkReference() if efficiency or real-time is an issue)
    * \return Qualified link to this element (may be shorter than qualified name, if object has a globally unique link)
    */
   inline tString GetQualifiedLink() const
@@ -381,7 +388,17 @@ public:
   }
 
   /*!
-   * (Use StringBuilder version if efficiency or real-time is an issue)
+   * Variant of above that returns a reference to a cached link (no string is built or copied if link has been requested before)
+   *
+   * \param link_index Index of link to start with
+   * \return Qualified link to this element via specified link
+   * (The returned reference remains valid until the framework element is deleted by the garbage deleter.
+   *  If element has been deleted, it contains the link before deletion.)
+   */
+  const tString& GetQualifiedLinkReference(size_t link_index = 0) const;
+
+  /*!
+   * (Use GetQualifiedNameReference() if efficiency or real-time is an issue)
    * \return Concatenation of parent names and this element's name
    */
   inline tString GetQualifiedName() const
@@ -428,6 +445,16 @@ public:
     GetQualifiedName(sb, start, true);
   }
 
+  /*!
+   * Variant of above that returns a reference to a cached name (no string is built or copied if name has been requested before)
+   *
+   * \param link_index Index of link to start with
+   * \return Concatenation of parent names and this element's name via specified link
+   * (The returned reference remains valid until the framework element is deleted by the garbage deleter.
+   *  If element has been deleted, it contains the name before deletion.)
+   */
+  const tString& GetQualifiedNameReference(size_t link_index = 0) const;
+
   /*!
    * (for convenience)
    * \return The one and only RuntimeEnvironment
@@ -451,6 +478,7 @@ public:
 
   /*!
    * Initializes all unitialized framework elements created by this thread
+   * (link edges are resolved in a single pass afterwards - see tRuntimeEnvironment::BeginDeferredLinkResolution())
    */
   static void InitAll();
 
@@ -552,8 +580,7 @@ public:
   /*!
    * \param name New Port name
    *
-   * (Name may only be changed once.
-   *  May only be called by creator thread before element is initialized.
+   * (May only be called by creator thread before element is initialized.
    *  Prints an error message otherwise and does not modify name.)
    */
   void SetName(const tString& name);
@@ -600,22 +627,27 @@ public:
     /* Framework element that link points to */
     tFrameworkElement& points_to;
 
-    /*! Name of Framework Element - in link context */
+    /*! Name of Framework Element - in link context (interned - see internal::tNamePool) */
     const tString* name;
 
-    /*! Buffer used for storing (initial) name of framework element */
-    tString name_buffer;
+    /*! Parent - Element in which this link was inserted (atomic, as it is read without structure mutex - stored with release semantics) */
+    std::atomic<tFrameworkElement*> parent;
+
+    /*! Next link for this framework element (=> singly-linked list; atomic, as it is read without structure mutex - stored with release semantics) */
+    std::atomic<tFrameworkElement::tLink*> next;
 
-    /*! Parent - Element in which this link was inserted */
-    tFrameworkElement* parent;
+    /*! Cached qualified name and link - NULL if they have not been requested yet */
+    mutable std::atomic<const tQualifiedNames*> qualified_names;
 
-    /*! Next link for this framework element (=> singly-linked list) */
-    tFrameworkElement::tLink* next;
+    /*! Value of naming_stamp_counter when name or parent of this link last changed (may only be accessed with structure mutex) */
+    uint64_t naming_stamp;
 
   public:
 
     tLink(tFrameworkElement& pointed_to);
 
+    ~tLink();
+
     /*!
      * \return Element that this link points to
      */
@@ -637,7 +669,7 @@ public:
      */
     inline tFrameworkElement* GetParent() const
     {
-      return parent;
+      return parent.load(std::memory_order_acquire);
     }
 
     /*!
@@ -832,9 +864,11 @@ protected:
 
   /*!
    * Create link to this framework element
+   * (may only be called before element is initialized - links of ready elements are read without structure mutex)
    *
    * \param parent Parent framework element
    * \param link_name name of link
+   * \throw Throws std::runtime_error if element is already initialized or deleted
    */
   void Link(tFrameworkElement& parent, const tString& link_name);
 
@@ -897,12 +931,30 @@ private:
    */
   tFlags flags;  // TODO: Check whether splitting flags up in const and non-const might allow compiler optimizations?
 
-  /*! Children (concurrent set for efficient, thread-safe iteration) - points to empty_child_set for ports - never NULL */
+  /*!
+   * Children (concurrent set for efficient, thread-safe iteration) - points to empty_child_set for ports - never NULL
+   * (modified with structure mutex and this element's child set mutex acquired - see tRuntimeEnvironment)
+   */
   tChildSet* children;
 
   /*! Empty child set for ports */
   static tChildSet empty_child_set;
 
+  /*!
+   * Incremented whenever a link is renamed, relinked, or deleted (with structure mutex acquired).
+   * The new value is stored in the link's naming_stamp (see NameChanged()).
+   */
+  static std::atomic<uint64_t> naming_stamp_counter;
+
+  /*! Number of links in child set (may only be modified with structure mutex and child set mutex acquired) */
+  std::atomic<size_t> child_link_count;
+
+  /*!
+   * Index of child links by name - created lazily for elements with many children (see GetChildNameIndex()).
+   * NULL otherwise.
+   */
+  mutable internal::tChildNameIndex* child_name_index;
+
   /*!
    * Adds child to parent (automatically called by constructor - may be called again though)
    * using specified link
@@ -954,18 +1006,93 @@ private:
    */
   tFrameworkElement* GetChildElement(const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root);
 
+  /*!
+   * Helper for above: Continues lookup with child link whose name matches the name at 'name_index'
+   *
+   * \param child Child link
+   * \param name (relative) Qualified name
+   * \param name_index Current index in string (position of child name)
+   * \param only_globally_unique_children Only return child with globally unique link?
+   * \param root Root element
+   * \return Framework element - or null if non-existent
+   */
+  tFrameworkElement* GetChildElementHelper(tLink& child, const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root);
+
+  /*!
+   * Looks up child link in child name index
+   * (acquires this element's child set mutex - it is released again before returning)
+   *
+   * \param name String that contains name of child to look for (e.g. a qualified link)
+   * \param name_index Index of name's first character in 'name'
+   * \param name_length Length of name
+   * \param candidate_index Index of link among the non-deleted child links with this name (in no particular order)
+   * \param indexed Is set to false if this element has no child name index (no link is returned then)
+   * \return Link - or NULL if there are no further links with this name
+   */
+  tLink* GetIndexedChildLink(const tString& name, size_t name_index, size_t name_length, size_t candidate_index, bool& indexed) const;
+
+  /*!
+   * Returns index of child links by name - and creates it if this element has enough children and it does not exist yet.
+   * (see tChildNameIndex on which lock is required)
+   *
+   * \return Child name index - or NULL if this element has too few children for an index
+   */
+  internal::tChildNameIndex* GetChildNameIndex() const;
+
+  /*!
+   * \return Mutex that guards child set, child name index and child names of this element (see tRuntimeEnvironment for locking protocol)
+   */
+  rrlib::thread::tOrderedMutex& GetChildSetMutex() const;
+
+  /*!
+   * Lock-free variant of above that only considers ready elements
+   * (may only be called on ready elements)
+   *
+   * \param name (relative) Qualified name
+   * \param name_index Current index in string
+   * \param only_globally_unique_children Only return child with globally unique link?
+   * \param root Root element
+   * \param complete Is set to false if elements were skipped that were not ready (result might be incomplete then)
+   * \return Framework element - or null if non-existent
+   */
+  tFrameworkElement* GetReadyChildElement(const tString& name, int name_index, bool only_globally_unique_children, tFrameworkElement& root, bool& complete);
+
   /*!
    * \return Number of links to this port
    * (should be called in synchronized context)
    */
   size_t GetLinkCountHelper() const;
 
+  /*!
+   * \param link_index Index of link (0 = primary)
+   * \return Link with specified index - or NULL if there is no such link
+   * (should be called in synchronized context - or on ready element)
+   */
+  const tLink* GetLinkHelper(size_t link_index) const;
+
+  /*!
+   * Helper for GetParentWithFlags()
+   * (should be called in synchronized context - or on ready element)
+   */
+  tFrameworkElement* GetParentWithFlagsHelper(tFlags parent_flags) const;
+
   /*!
    * same as above, but non-const
    * (should be called in synchronized context)
    */
   tLink* GetLinkInternal(size_t link_index);
 
+  /*!
+   * Helper for IsChildOf()
+   * (should be called in synchronized context - or on ready element)
+   */
+  bool IsChildOfHelper(const tFrameworkElement& re, bool ignore_delete_flag) const;
+
+  /*!
+   * \return True if this element has enough children to look them up using child name index
+   */
+  bool UsesChildNameIndex() const;
+
   /*!
    * Recursive Helper function for above
    *
@@ -997,6 +1124,20 @@ private:
    */
   bool GetQualifiedNameImpl(tString& sb, const tLink& start, bool force_full_link) const;
 
+  /*!
+   * Returns qualified name and link of specified link - and computes and caches them if necessary.
+   *
+   * Qualified names and links of ready elements with ready parents cannot change anymore (apart from deletion - see NameChanged()).
+   * Therefore, they are computed only once - and can afterwards be obtained without locking.
+   * Cached names of other elements are only valid as long as no link on the path to the root has changed since they were computed
+   * (checked via the links' naming stamps).
+   * Replaced caches are deleted via the garbage deleter, as references to them may still be in use.
+   *
+   * \param link Link to obtain qualified name and link of
+   * \return Qualified names
+   */
+  const tQualifiedNames& GetQualifiedNames(const tLink& link) const;
+
   /*!
    * Initializes element and all child elements that were created by this thread
    * (helper method for Init())
@@ -1016,6 +1157,26 @@ private:
    */
   void ManagedDelete(tLink* dont_detach);
 
+  /*!
+   * Invalidates cached qualified names of link and all links below it
+   * (must be called with structure mutex whenever name or parent of link changes - e.g. on rename, relink, or deletion).
+   * The link's own cache is no longer final afterwards - so it is checked against the naming stamps (and replaced) on next access.
+   *
+   * \param link Link whose name or parent has changed
+   */
+  static void NameChanged(tLink& link);
+
+  /*!
+   * Called whenever a child has been added to or removed from this element
+   * (called in runtime-registry-synchronized context)
+   *
+   * \param child Child element
+   * \param added Was child added? (otherwise it was removed)
+   */
+  virtual void OnChildChange(tFrameworkElement& child, bool added)
+  {
+  }
+
   /*!
    * Initializes this runtime element.
    * The tree structure should be established by now (Uid is valid)
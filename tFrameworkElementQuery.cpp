@@ -0,0 +1,300 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tFrameworkElementQuery.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/tFrameworkElementQuery.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tFrameworkElementTags.h"
+#include "core/tRuntimeEnvironment.h"
+#include "core/port/tAbstractPort.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+/*! Number of elements obtained from element register at once (when scanning register) */
+const size_t cREGISTER_SCAN_BUFFER_SIZE = 256;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+tFrameworkElementQuery::tFrameworkElementQuery(const tString& path_pattern) :
+  path(),
+  required_flags(),
+  excluded_flags(),
+  data_type_uid(-1),
+  tag()
+{
+  size_t start = 0;
+  while (start <= path_pattern.length())
+  {
+    size_t end = path_pattern.find('/', start);
+    end = (end == tString::npos) ? path_pattern.length() : end;
+    if (end > start)
+    {
+      tPathElement element;
+      element.pattern = path_pattern.substr(start, end - start);
+      element.type = element.pattern == "**" ? tPathElementType::ANY_LEVELS :
+                     (element.pattern.find_first_of("*?") != tString::npos ? tPathElementType::PATTERN : tPathElementType::NAME);
+      if (!(element.type == tPathElementType::ANY_LEVELS && path.size() > 0 && path.back().type == tPathElementType::ANY_LEVELS))
+      {
+        path.push_back(element);
+      }
+    }
+    start = end + 1;
+  }
+}
+
+void tFrameworkElementQuery::AddToState(tState& state, size_t index) const
+{
+  while (true)
+  {
+    if (std::find(state.begin(), state.end(), index) == state.end())
+    {
+      state.insert(std::upper_bound(state.begin(), state.end(), index), index);
+    }
+    if (index < path.size() && path[index].type == tPathElementType::ANY_LEVELS)
+    {
+      index++;  // "**" may match no hierarchy level
+    }
+    else
+    {
+      return;
+    }
+  }
+}
+
+bool tFrameworkElementQuery::GlobMatch(const tString& pattern, const tString& name)
+{
+  size_t p = 0, n = 0;
+  size_t star_p = tString::npos, star_n = 0;
+  while (n < name.length())
+  {
+    if (p < pattern.length() && (pattern[p] == '?' || pattern[p] == name[n]))
+    {
+      p++;
+      n++;
+    }
+    else if (p < pattern.length() && pattern[p] == '*')
+    {
+      star_p = p++;
+      star_n = n;
+    }
+    else if (star_p != tString::npos)
+    {
+      p = star_p + 1;
+      n = ++star_n;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  while (p < pattern.length() && pattern[p] == '*')
+  {
+    p++;
+  }
+  return p == pattern.length();
+}
+
+bool tFrameworkElementQuery::MatchesPredicates(tFrameworkElement& element) const
+{
+  uint32_t flags = element.GetAllFlags().Raw();
+  if ((flags & required_flags.Raw()) != required_flags.Raw() || (flags & excluded_flags.Raw()))
+  {
+    return false;
+  }
+  if (data_type_uid >= 0 && ((!element.IsPort()) || static_cast<tAbstractPort&>(element).GetDataType().GetUid() != data_type_uid))
+  {
+    return false;
+  }
+  return tag.length() == 0 || tFrameworkElementTags::IsTagged(element, tag);
+}
+
+size_t tFrameworkElementQuery::Run(tResultListener& listener, tFrameworkElement* root) const
+{
+  size_t result_count = 0;
+  if ((!root) && path.size() == 1 && path[0].type == tPathElementType::ANY_LEVELS)
+  {
+    ScanRegister(listener, result_count);
+    return result_count;
+  }
+
+  root = root ? root : &tRuntimeEnvironment::GetInstance();
+  if (root->IsReady())
+  {
+    tState state;
+    AddToState(state, 0);
+    Visit(*root, state, listener, result_count);
+  }
+  return result_count;
+}
+
+void tFrameworkElementQuery::ScanRegister(tResultListener& listener, size_t& result_count) const
+{
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  tRuntimeEnvironment::tElementFilter filter;
+  filter.flag_mask = required_flags | excluded_flags | tFlag::READY;
+  filter.flag_values = required_flags | tFlag::READY;
+  filter.data_type_uid = data_type_uid;
+
+  tFrameworkElement* buffer[cREGISTER_SCAN_BUFFER_SIZE];
+  tFrameworkElement::tHandle start_handle = 0;
+  while (true)
+  {
+    size_t count = runtime.FindElements(buffer, cREGISTER_SCAN_BUFFER_SIZE, filter, start_handle);
+    for (size_t i = 0; i < count; i++)
+    {
+      if (tag.length() == 0 || tFrameworkElementTags::IsTagged(*buffer[i], tag))
+      {
+        result_count++;
+        if (!listener.OnQueryResult(*buffer[i]))
+        {
+          return;
+        }
+      }
+    }
+    if (count < cREGISTER_SCAN_BUFFER_SIZE)
+    {
+      return;
+    }
+    start_handle = buffer[count - 1]->GetHandle() + 1;
+  }
+}
+
+bool tFrameworkElementQuery::Visit(tFrameworkElement& element, const tState& state, tResultListener& listener, size_t& result_count) const
+{
+  // If all path elements to match are names, look children up by name
+  bool only_names = true;
+  for (auto it = state.begin(); it != state.end(); ++it)
+  {
+    only_names &= (*it == path.size() || path[*it].type == tPathElementType::NAME);
+  }
+  if (only_names)
+  {
+    std::vector<tFrameworkElement*> visited_children;
+    for (auto it = state.begin(); it != state.end(); ++it)
+    {
+      tFrameworkElement* child = *it < path.size() ? element.GetChild(path[*it].pattern) : NULL;
+      if (child && child->IsReady() && child->GetParent() == &element && std::find(visited_children.begin(), visited_children.end(), child) == visited_children.end())
+      {
+        visited_children.push_back(child);
+        if (!VisitChild(*child, state, listener, result_count))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  for (auto it = element.ChildrenBegin(); it != element.ChildrenEnd(); ++it)
+  {
+    if (it->IsReady() && it->GetParent() == &element && (!VisitChild(*it, state, listener, result_count)))  // primary links only (so that no element is visited twice)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool tFrameworkElementQuery::VisitChild(tFrameworkElement& child, const tState& state, tResultListener& listener, size_t& result_count) const
+{
+  tState child_state;
+  for (auto it = state.begin(); it != state.end(); ++it)
+  {
+    if (*it == path.size())
+    {
+      continue;
+    }
+    const tPathElement& path_element = path[*it];
+    if (path_element.type == tPathElementType::ANY_LEVELS)
+    {
+      AddToState(child_state, *it);
+    }
+    else if ((path_element.type == tPathElementType::NAME && child.GetName() == path_element.pattern) ||
+             (path_element.type == tPathElementType::PATTERN && GlobMatch(path_element.pattern, child.GetName())))
+    {
+      AddToState(child_state, *it + 1);
+    }
+  }
+  if (child_state.empty())
+  {
+    return true;
+  }
+
+  if (child_state.back() == path.size() && MatchesPredicates(child))
+  {
+    result_count++;
+    if (!listener.OnQueryResult(child))
+    {
+      return false;
+    }
+  }
+  if (child_state.size() > 1 || child_state[0] < path.size())
+  {
+    return Visit(child, child_state, listener, result_count);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
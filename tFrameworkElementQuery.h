@@ -0,0 +1,256 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tFrameworkElementQuery.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tFrameworkElementQuery
+ *
+ * \b tFrameworkElementQuery
+ *
+ * Query for framework elements with glob-style path patterns
+ * as well as flag, data type, and tag predicates.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__tFrameworkElementQuery_h__
+#define __core__tFrameworkElementQuery_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/rtti/rtti.h"
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tFrameworkElement.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Framework element query
+/*!
+ * Query for framework elements with glob-style path patterns
+ * as well as flag, data type, and tag predicates.
+ *
+ * Path patterns consist of elements separated by slashes.
+ * In every path element, '*' matches any sequence of characters and '?' matches any single character.
+ * A path element "**" matches any number of hierarchy levels (including none).
+ * E.g. the pattern "/Main/" + "**" + "/Sensor*" matches all elements below "/Main" whose names start with "Sensor".
+ * (Names containing slashes cannot be matched by a single path element.)
+ *
+ * Results are passed to a listener as they are found (no result lists are built).
+ * Only ready elements are considered. The query does not acquire the structure mutex
+ * while evaluating path patterns or calling the listener. So elements may be deleted
+ * concurrently - lock the structure mutex to obtain consistent results.
+ *
+ * Queries use any indices available:
+ * Path elements without wildcards are looked up by name (using child name indices of elements with many children).
+ * If there are no path constraints, the runtime's element register (with flags and data types) is scanned instead of the tree.
+ */
+class tFrameworkElementQuery
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef tFrameworkElement::tFlag tFlag;
+  typedef tFrameworkElement::tFlags tFlags;
+
+  /*! Receives query results */
+  class tResultListener
+  {
+  public:
+
+    virtual ~tResultListener() {}
+
+    /*!
+     * Called for every framework element matching query
+     *
+     * \param element Framework element
+     * \return Continue query? (false aborts query)
+     */
+    virtual bool OnQueryResult(tFrameworkElement& element) = 0;
+  };
+
+  /*!
+   * \param path_pattern Pattern that qualified names of elements must match (relative to root element - see Run()). "**" matches all elements.
+   */
+  explicit tFrameworkElementQuery(const tString& path_pattern = "**");
+
+  /*!
+   * Executes query
+   *
+   * \param listener Listener that receives results
+   * \param root Root element that path pattern is relative to (runtime environment if NULL). Root element itself is never a result.
+   * \return Number of elements that matched query
+   */
+  size_t Run(tResultListener& listener, tFrameworkElement* root = NULL) const;
+
+  /*!
+   * \param type Only ports with this data type match query
+   */
+  void SetDataType(const rrlib::rtti::tType& type)
+  {
+    data_type_uid = type.GetUid();
+  }
+
+  /*!
+   * \param flags Only elements that have none of these flags set match query
+   */
+  void SetExcludedFlags(tFlags flags)
+  {
+    excluded_flags = flags;
+  }
+
+  /*!
+   * \param flags Only elements that have all of these flags set match query
+   */
+  void SetRequiredFlags(tFlags flags)
+  {
+    required_flags = flags;
+  }
+
+  /*!
+   * \param tag Only elements with this tag match query (see tFrameworkElementTags). Empty string accepts any element.
+   */
+  void SetTag(const tString& tag)
+  {
+    this->tag = tag;
+  }
+
+  /*!
+   * \param pattern Glob pattern ('*' and '?' are wildcards)
+   * \param name Name to check
+   * \return True if name matches pattern
+   */
+  static bool GlobMatch(const tString& pattern, const tString& name);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Types of path elements in pattern */
+  enum class tPathElementType
+  {
+    NAME,      //!< Name without wildcards
+    PATTERN,   //!< Name with wildcards
+    ANY_LEVELS //!< "**"
+  };
+
+  /*! Path element in pattern */
+  struct tPathElement
+  {
+    tPathElementType type;
+    tString pattern;
+  };
+
+  /*!
+   * State of query at a framework element in tree: Indices of path elements that the next child needs to match (sorted).
+   * Index path.size() means that the element itself matches the path pattern.
+   */
+  typedef std::vector<size_t> tState;
+
+  /*! Path pattern split up into elements */
+  std::vector<tPathElement> path;
+
+  /*! Flags that elements need to have set - and flags that elements must not have set */
+  tFlags required_flags, excluded_flags;
+
+  /*! Uid of data type that ports must have (-1 accepts any data type) */
+  int data_type_uid;
+
+  /*! Tag that elements must have (empty string accepts any element) */
+  tString tag;
+
+  /*!
+   * Adds path element index to state - as well as any indices reachable without matching another element (after "**")
+   *
+   * \param state State to add index to
+   * \param index Index to add
+   */
+  void AddToState(tState& state, size_t index) const;
+
+  /*!
+   * \param element Element to check
+   * \return True if element matches flag, data type, and tag predicates of query
+   */
+  bool MatchesPredicates(tFrameworkElement& element) const;
+
+  /*!
+   * Scans the element register (used for queries without path constraints)
+   *
+   * \param listener Listener that receives results
+   * \param result_count Number of results - is incremented for every result
+   */
+  void ScanRegister(tResultListener& listener, size_t& result_count) const;
+
+  /*!
+   * Checks children of element against query (recursively)
+   *
+   * \param element Element whose children to check
+   * \param state Query state at element
+   * \param listener Listener that receives results
+   * \param result_count Number of results - is incremented for every result
+   * \return False if listener aborted query
+   */
+  bool Visit(tFrameworkElement& element, const tState& state, tResultListener& listener, size_t& result_count) const;
+
+  /*!
+   * Checks child of element against query (recursively)
+   *
+   * \param child Child to check
+   * \param state Query state at parent element
+   * \param listener Listener that receives results
+   * \param result_count Number of results - is incremented for every result
+   * \return False if listener aborted query
+   */
+  bool VisitChild(tFrameworkElement& child, const tState& state, tResultListener& listener, size_t& result_count) const;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -90,6 +90,9 @@ enum class tLockOrderLevel : int
   /*! Links to stuff in remote runtime environment */
   REMOTE_LINKING = 500000,
 
+  /*! Child sets of framework elements (may be acquired with runtime register locked) */
+  CHILD_SET = 900000,
+
   /*! Stuff to lock before everything else */
   FIRST = 0,
 
@@ -33,15 +33,21 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/thread/tThread.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "core/tLockOrderLevel.h"
 #include "core/tRuntimeSettings.h"
+#include "core/internal/tChildNameIndex.h"
 #include "core/internal/tGarbageDeleter.h"
 #include "core/internal/tLinkEdge.h"
+#include "core/internal/tNamePool.h"
 #include "core/internal/tPlugins.h"
+#include "core/internal/tStructureLock.h"
 #include "core/port/tAbstractPort.h"
 
 //----------------------------------------------------------------------
@@ -73,6 +79,102 @@ typedef rrlib::thread::tLock tLock;
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
+
+namespace
+{
+
+/*! Orders link indices by link (used to sort links in ResolveLinks()) */
+struct tLinkOrder
+{
+  /*! Links that indices refer to */
+  const tString* links;
+
+  bool operator()(size_t index1, size_t index2) const
+  {
+    return links[index1] < links[index2];
+  }
+};
+
+/*! Element or edge that a change refers to (edge target is NULL for element changes) */
+typedef std::pair<tFrameworkElement*, tAbstractPort*> tChangeKey;
+
+/*! Hash function for tChangeKey */
+struct tChangeKeyHash
+{
+  size_t operator()(const tChangeKey& key) const
+  {
+    return std::hash<tFrameworkElement*>()(key.first) ^ (std::hash<tAbstractPort*>()(key.second) * 31);
+  }
+};
+
+/*!
+ * Coalesces changes to the same element (or edge) in a batch of changes:
+ * - CHANGE events following ADD or CHANGE are dropped (listeners see the current state when processing ADD)
+ * - CHANGE events followed by REMOVE are dropped
+ * - ADD followed by REMOVE cancels out (PRE_INIT is dropped as well) - listeners never see the element (or edge)
+ * Otherwise, the order of changes is preserved.
+ *
+ * \param changes Changes to coalesce (in the order they occurred)
+ */
+void CoalesceChanges(std::vector<tRuntimeListener::tChange>& changes)
+{
+  typedef tRuntimeListener::tEvent tEvent;
+  std::vector<bool> keep(changes.size(), true);
+  std::unordered_map<tChangeKey, size_t, tChangeKeyHash> last_change, pre_init;
+  for (size_t i = 0; i < changes.size(); i++)
+  {
+    const tRuntimeListener::tChange& change = changes[i];
+    tChangeKey key(change.element, change.edge_target);
+    if (change.change_type == tEvent::PRE_INIT)
+    {
+      pre_init[key] = i;
+      continue;
+    }
+
+    auto last = last_change.find(key);
+    if (last != last_change.end())
+    {
+      tEvent last_type = changes[last->second].change_type;
+      if (change.change_type == tEvent::CHANGE && (last_type == tEvent::ADD || last_type == tEvent::CHANGE))
+      {
+        keep[i] = false;
+        continue;
+      }
+      if (change.change_type == tEvent::REMOVE && last_type == tEvent::CHANGE)
+      {
+        keep[last->second] = false;
+      }
+      else if (change.change_type == tEvent::REMOVE && last_type == tEvent::ADD)
+      {
+        keep[last->second] = false;
+        keep[i] = false;
+        auto init = pre_init.find(key);
+        if (init != pre_init.end())
+        {
+          keep[init->second] = false;
+          pre_init.erase(init);
+        }
+        last_change.erase(last);
+        continue;
+      }
+    }
+    last_change[key] = i;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < changes.size(); i++)
+  {
+    if (keep[i])
+    {
+      changes[kept] = changes[i];
+      kept++;
+    }
+  }
+  changes.erase(changes.begin() + kept, changes.end());
+}
+
+}
+
 typedef rrlib::design_patterns::tSingletonHolder<tRuntimeEnvironment, rrlib::design_patterns::singleton::Longevity> tRuntimeEnvironmentInstance;
 static inline unsigned int GetLongevity(tRuntimeEnvironment*)
 {
@@ -90,9 +192,18 @@ tRuntimeEnvironment::tRuntimeEnvironment() :
   elements(),
   link_edges(),
   global_link_edges(),
+  link_patterns(),
+  pattern_link_edges(),
   runtime_listeners(),
   temp_buffer(),
+  port_links(),
+  unpublished_port_count(0),
   alternative_link_roots(),
+  change_batch(),
+  change_batch_depth(0),
+  link_resolution_defer_depth(0),
+  deferred_ports(),
+  deferred_link_edges(),
   structure_mutex("Runtime Registry", static_cast<int>(tLockOrderLevel::RUNTIME_REGISTER)),
   creation_time(rrlib::time::Now()),
   command_line_args(),
@@ -108,6 +219,7 @@ tRuntimeEnvironment::tRuntimeEnvironment() :
 tRuntimeEnvironment::~tRuntimeEnvironment()
 {
   global_link_edges.clear();
+  pattern_link_edges.clear();
   active = false;
   rrlib::thread::tThread::StopThreads();
 
@@ -123,27 +235,28 @@ tRuntimeEnvironment::~tRuntimeEnvironment()
   instance_raw_ptr = NULL;
 }
 
-void tRuntimeEnvironment::AddLinkEdge(const tString& link, internal::tLinkEdge& edge)
+void tRuntimeEnvironment::AddLinkEdge(internal::tNamePool::tAtom link, internal::tLinkEdge& edge)
 {
-  FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Adding link edge connecting to ", link);
+  FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Adding link edge connecting to ", *link);
   {
-    tLock lock(structure_mutex);
-    if (link_edges.find(link) == link_edges.end())
-    {
-      // add first edge
-      link_edges[link] = &edge;
-    }
-    else
+    internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::AddLinkEdge");
+    std::pair<decltype(link_edges)::iterator, bool> result = link_edges.insert(std::make_pair(link, &edge));
+    if (!result.second)
     {
       // insert edge
-      internal::tLinkEdge* interested = link_edges[link];
+      internal::tLinkEdge* interested = result.first->second;
       internal::tLinkEdge* next = interested->GetNextEdge();
       interested->SetNextEdge(&edge);
       edge.SetNextEdge(next);
     }
 
     // directly notify link edge?
-    tAbstractPort* p = GetPort(link);
+    if (link_resolution_defer_depth)
+    {
+      deferred_link_edges.push_back(std::make_pair(link, &edge));
+      return;
+    }
+    tAbstractPort* p = GetPort(*link);
     if (p && p->IsReady())
     {
       edge.LinkAdded(*this, link, *p);
@@ -153,13 +266,19 @@ void tRuntimeEnvironment::AddLinkEdge(const tString& link, internal::tLinkEdge&
 
 void tRuntimeEnvironment::AddListener(tRuntimeListener& listener)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::AddListener");
   runtime_listeners.Add(&listener);
 }
 
+size_t tRuntimeEnvironment::FindElements(tFrameworkElement** result_buffer, size_t max_elements, const tElementFilter& filter, tHandle start_from_handle)
+{
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::FindElements");
+  return elements.FindElements(result_buffer, max_elements, start_from_handle, filter);
+}
+
 size_t tRuntimeEnvironment::GetAllElements(tFrameworkElement** result_buffer, size_t max_elements, tHandle start_from_handle)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::GetAllElements");
   return elements.GetAllElements(result_buffer, max_elements, start_from_handle);
 }
 
@@ -172,6 +291,138 @@ size_t tRuntimeEnvironment::GetAllPorts(tAbstractPort** result_buffer, size_t ma
   return GetAllElements(reinterpret_cast<tFrameworkElement**>(result_buffer), max_ports, start_from_handle);
 }
 
+void tRuntimeEnvironment::BeginChangeBatch()
+{
+  change_batch_depth++;
+}
+
+void tRuntimeEnvironment::BeginDeferredLinkResolution()
+{
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::BeginDeferredLinkResolution");
+  link_resolution_defer_depth++;
+}
+
+void tRuntimeEnvironment::EndDeferredLinkResolution()
+{
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::EndDeferredLinkResolution");
+  assert(link_resolution_defer_depth > 0);
+  link_resolution_defer_depth--;
+  if (link_resolution_defer_depth > 0 || ShuttingDown())
+  {
+    return;
+  }
+
+  // Resolve what was added while deferred only:
+  // Ports published in the meantime are checked against all link edges.
+  // Link edges added in the meantime are checked against ports that were published before.
+  std::vector<tAbstractPort*> ports;
+  std::vector<std::pair<internal::tNamePool::tAtom, internal::tLinkEdge*>> edges;
+  ports.swap(deferred_ports);
+  edges.swap(deferred_link_edges);
+  std::unordered_set<tAbstractPort*> new_ports(ports.begin(), ports.end());
+  BeginChangeBatch();
+  try
+  {
+    for (auto it = ports.begin(); it != ports.end(); ++it)
+    {
+      CheckLinkEdges(**it);
+    }
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+    {
+      tAbstractPort* port = port_links.Find(*it->first);
+      if (port && port->IsReady() && new_ports.count(port) == 0)
+      {
+        it->second->LinkAdded(*this, it->first, *port);
+      }
+    }
+  }
+  catch (...)
+  {
+    EndChangeBatch();
+    throw;
+  }
+  EndChangeBatch();
+}
+
+void tRuntimeEnvironment::CheckLinkEdges(tAbstractPort& port)
+{
+  for (size_t i = 0u; i < port.GetLinkCount(); i++)
+  {
+    const tString& s = port.GetQualifiedLinkReference(i);  // cached - and not modified by link edges below (in contrast to temp_buffer)
+    FINROC_LOG_PRINT(DEBUG_VERBOSE_2, "Checking link ", s, " with respect to link edges");
+
+    // links that link edges are interested in are interned - so links without atom can be skipped without any lookup in link_edges
+    internal::tNamePool::tAtom atom = link_edges.empty() ? NULL : internal::tNamePool::Find(s);
+    auto interested = atom ? link_edges.find(atom) : link_edges.end();
+    if (interested != link_edges.end())
+    {
+      for (internal::tLinkEdge* le = interested->second; le; le = le->GetNextEdge())
+      {
+        le->LinkAdded(*this, atom, port);
+      }
+    }
+  }
+  if (port.link_edges)
+  {
+    for (auto it = port.link_edges->begin(); it != port.link_edges->end(); ++it)
+    {
+      (*it)->PortAdded(*this);
+    }
+  }
+}
+
+void tRuntimeEnvironment::ConnectPatternMatches(tAbstractPort& port, const internal::tLinkPatternIndex::tPatternPair* pattern_pair)
+{
+  std::vector<internal::tLinkPatternIndex::tMatch> matches;
+  for (size_t i = 0; i < port.GetLinkCount(); i++)
+  {
+    const tString& name = port.GetQualifiedNameReference(i);
+    const tString& link = port.GetQualifiedLinkReference(i);
+    link_patterns.FindMatches(name, matches, pattern_pair);
+    if (&link != &name && link != name)
+    {
+      link_patterns.FindMatches(link, matches, pattern_pair);
+    }
+  }
+  for (auto it = matches.begin(); it != matches.end(); ++it)
+  {
+    FINROC_LOG_PRINT(DEBUG_VERBOSE_1, "Link pattern matched: connecting ", it->source_link, " and ", it->target_link);
+
+    // link edge refers to port by pointer - so that it is deleted with port (see UnregisterElement())
+    tPatternLinkEdge pattern_edge;
+    pattern_edge.pattern_pair = it->pattern_pair;
+    if (it->link_is_source)
+    {
+      pattern_edge.edge.reset(new internal::tLinkEdge(port, it->target_link, it->both_connect_directions));
+    }
+    else
+    {
+      pattern_edge.edge.reset(new internal::tLinkEdge(it->source_link, port, it->both_connect_directions));
+    }
+    pattern_link_edges[&port].push_back(std::move(pattern_edge));
+  }
+}
+
+void tRuntimeEnvironment::EndChangeBatch()
+{
+  assert(change_batch_depth > 0);
+  change_batch_depth--;
+  if (change_batch_depth > 0 || change_batch.empty())
+  {
+    return;
+  }
+  std::vector<tRuntimeListener::tChange> changes;
+  changes.swap(change_batch);
+  CoalesceChanges(changes);
+  if ((!ShuttingDown()) && changes.size() > 0)
+  {
+    for (auto it = runtime_listeners.Begin(); it != runtime_listeners.End(); ++it)
+    {
+      (*it)->OnStructureChangeBatch(&changes[0], changes.size());
+    }
+  }
+}
+
 tString tRuntimeEnvironment::GetCommandLineArgument(const tString& name)
 {
   if (command_line_args.find(name) != command_line_args.end())
@@ -207,7 +458,7 @@ tRuntimeEnvironment& tRuntimeEnvironment::GetInstance()
 
 tAbstractPort* tRuntimeEnvironment::GetPort(tHandle port_handle)
 {
-  if (port_handle < 0x80000000)
+  if (port_handle < internal::tFrameworkElementRegister::cFIRST_PORT_HANDLE)
   {
     throw std::runtime_error("No port handle");
   }
@@ -221,8 +472,18 @@ tAbstractPort* tRuntimeEnvironment::GetPort(tHandle port_handle)
 
 tAbstractPort* tRuntimeEnvironment::GetPort(const tString& link_name)
 {
-  tLock lock(structure_mutex);
+  tAbstractPort* port = port_links.Find(link_name);  // lock-free
+  if (port && port->IsDeleted())
+  {
+    port = NULL;  // deleted concurrently - but not removed from index yet
+  }
+  if (port || unpublished_port_count.load() == 0)
+  {
+    return port;
+  }
 
+  // port might not be published yet
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::GetPort");
   tFrameworkElement* fe = GetChildElement(link_name, false);
   if (fe == NULL)
   {
@@ -274,7 +535,12 @@ void tRuntimeEnvironment::InitialInit()
 
 void tRuntimeEnvironment::PreElementInit(tFrameworkElement& element)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::PreElementInit");
+  if (change_batch_depth > 0)
+  {
+    change_batch.push_back(tRuntimeListener::tChange(tRuntimeListener::tEvent::PRE_INIT, element, NULL));
+    return;
+  }
   for (auto it = runtime_listeners.Begin(); it != runtime_listeners.End(); ++it)
   {
     (*it)->OnFrameworkElementChange(tRuntimeListener::tEvent::PRE_INIT, element);
@@ -283,29 +549,56 @@ void tRuntimeEnvironment::PreElementInit(tFrameworkElement& element)
 
 tRuntimeEnvironment::tHandle tRuntimeEnvironment::RegisterElement(tFrameworkElement& fe, bool port)
 {
-  tLock lock(structure_mutex);
-  return elements.Add(fe, port);
+  if (port)
+  {
+    unpublished_port_count++;
+  }
+  return elements.Add(fe, port); // register is thread-safe - no need to acquire structure mutex
 }
 
-void tRuntimeEnvironment::RemoveLinkEdge(const tString& link, internal::tLinkEdge& edge)
+void tRuntimeEnvironment::RemoveLinkPattern(const internal::tLinkPatternIndex::tPatternPair& pattern_pair)
 {
-  tLock lock(structure_mutex);
-  internal::tLinkEdge* current = link_edges[link];
+  for (auto entry = pattern_link_edges.begin(); entry != pattern_link_edges.end();)
+  {
+    std::vector<tPatternLinkEdge>& edges = entry->second;
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+      if (edges[i].pattern_pair == &pattern_pair)
+      {
+        edges[i].edge->DisconnectCreatedConnections(*this);  // connections that existed before - or were created by other means - remain
+        edges.erase(edges.begin() + i);
+        i--;
+      }
+    }
+    entry = edges.empty() ? pattern_link_edges.erase(entry) : std::next(entry);
+  }
+  link_patterns.Remove(pattern_pair);
+}
+
+void tRuntimeEnvironment::RemoveLinkEdge(internal::tNamePool::tAtom link, internal::tLinkEdge& edge)
+{
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::RemoveLinkEdge");
+  if (link_resolution_defer_depth)
+  {
+    deferred_link_edges.erase(std::remove(deferred_link_edges.begin(), deferred_link_edges.end(), std::make_pair(link, &edge)), deferred_link_edges.end());
+  }
+  auto entry = link_edges.find(link);
+  internal::tLinkEdge* current = entry != link_edges.end() ? entry->second : NULL;
   if (current == &edge)
   {
     if (current->GetNextEdge() == NULL)    // remove entries for this link completely
     {
-      link_edges.erase(link);
+      link_edges.erase(entry);
     }
     else    // remove first element
     {
-      link_edges[link] = current->GetNextEdge();
+      entry->second = current->GetNextEdge();
     }
   }
   else    // remove element out of linked list
   {
     internal::tLinkEdge* prev = current;
-    current = current->GetNextEdge();
+    current = current ? current->GetNextEdge() : NULL;
     while (current != NULL)
     {
       if (current == &edge)
@@ -316,21 +609,127 @@ void tRuntimeEnvironment::RemoveLinkEdge(const tString& link, internal::tLinkEdg
       prev = current;
       current = current->GetNextEdge();
     }
-    FINROC_LOG_PRINT(DEBUG_WARNING, "Could not remove link edge for link: ", link);
+    FINROC_LOG_PRINT(DEBUG_WARNING, "Could not remove link edge for link: ", *link);
   }
 }
 
 void tRuntimeEnvironment::RemoveListener(tRuntimeListener& listener)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::RemoveListener");
   runtime_listeners.Remove(&listener);
 }
 
+void tRuntimeEnvironment::ResolveLinks(const tString* links, size_t link_count, tFrameworkElement** result_buffer)
+{
+  // process links in sorted order
+  std::vector<size_t> order(link_count);
+  for (size_t i = 0; i < link_count; i++)
+  {
+    order[i] = i;
+  }
+  tLinkOrder link_order = { links };
+  std::sort(order.begin(), order.end(), link_order);
+
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::ResolveLinks");
+
+  // elements on path of previous link (with index of character after their name in previous link)
+  std::vector<std::pair<size_t, tFrameworkElement*>> path;
+  const tString* previous_link = NULL;
+  for (auto it = order.begin(); it != order.end(); ++it)
+  {
+    const tString& link = links[*it];
+    size_t name_start = (link.length() > 0 && link[0] == '/') ? 1 : 0;
+    result_buffer[*it] = NULL;
+
+    // keep elements of shared path prefix
+    size_t common_prefix_length = 0;
+    if (previous_link)
+    {
+      size_t max_length = std::min(link.length(), previous_link->length());
+      while (common_prefix_length < max_length && link[common_prefix_length] == (*previous_link)[common_prefix_length])
+      {
+        common_prefix_length++;
+      }
+    }
+    while (path.size() > 0 && (path.back().first > common_prefix_length || (path.back().first < link.length() && link[path.back().first] != '/')))
+    {
+      path.pop_back();
+    }
+    previous_link = &link;
+    if (link.length() == 0)
+    {
+      path.clear();
+      continue;
+    }
+
+    // resolve remaining path elements
+    tFrameworkElement* current = path.size() > 0 ? path.back().second : this;
+    name_start = path.size() > 0 ? path.back().first + 1 : name_start;
+    while (current && name_start <= link.length())
+    {
+      size_t name_end = link.find('/', name_start);
+      name_end = (name_end == tString::npos) ? link.length() : name_end;
+      current = ResolveLinkSegment(*current, link, name_start, name_end - name_start);
+      if (current)
+      {
+        path.push_back(std::pair<size_t, tFrameworkElement*>(name_end, current));
+      }
+      name_start = name_end + 1;
+    }
+
+    // names of framework elements may contain slashes - so fall back to ordinary lookup if link could not be resolved
+    result_buffer[*it] = current ? current : GetChildElement(link, false);
+  }
+}
+
+tFrameworkElement* tRuntimeEnvironment::ResolveLinkSegment(tFrameworkElement& parent, const tString& link, size_t name_start, size_t name_length)
+{
+  if (parent.UsesChildNameIndex())
+  {
+    rrlib::thread::tLock lock(parent.GetChildSetMutex());  // index may be created concurrently by GetChild()
+    internal::tChildNameIndex* index = parent.GetChildNameIndex();
+    if (index)
+    {
+      auto range = index->Find(link, name_start, name_length);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        if (!it->second->GetChild().IsDeleted())
+        {
+          return &it->second->GetChild();
+        }
+      }
+      return NULL;
+    }
+  }
+
+  for (auto it = parent.children->Begin(); it != parent.children->End(); ++it)
+  {
+    const tString& name = (*it)->GetName();
+    if (name.length() == name_length && link.compare(name_start, name_length, name) == 0 && (!(*it)->GetChild().IsDeleted()))
+    {
+      return &(*it)->GetChild();
+    }
+  }
+  return NULL;
+}
+
 void tRuntimeEnvironment::RuntimeChange(tRuntimeListener::tEvent change_type, tFrameworkElement& element, tAbstractPort* edge_target, bool notify_listeners_only)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::RuntimeChange");
+  if (change_type == tRuntimeListener::tEvent::ADD && element.IsPort() && (!edge_target))
+  {
+    port_links.Add(static_cast<tAbstractPort&>(element));
+    unpublished_port_count--;
+  }
+
   if (!ShuttingDown())
   {
+    elements.MarkChanged(element.GetHandle());
+    if (edge_target)
+    {
+      elements.MarkChanged(edge_target->GetHandle());
+    }
+
     if (!notify_listeners_only)
     {
 
@@ -346,51 +745,30 @@ void tRuntimeEnvironment::RuntimeChange(tRuntimeListener::tEvent change_type, tF
         }
       }
 
-      if (change_type == tRuntimeListener::tEvent::ADD && element.IsPort())    // check links
+      if (change_type == tRuntimeListener::tEvent::ADD && element.IsPort() && (!edge_target))    // check links
       {
-        tAbstractPort& ap = static_cast<tAbstractPort&>(element);
-        for (size_t i = 0u; i < ap.GetLinkCount(); i++)
+        if (link_resolution_defer_depth)
         {
-          ap.GetQualifiedLink(temp_buffer, i);
-          tString s = temp_buffer;
-          FINROC_LOG_PRINT(DEBUG_VERBOSE_2, "Checking link ", s, " with respect to link edges");
-
-          if (link_edges.find(s) != link_edges.end())
-          {
-            internal::tLinkEdge* le = link_edges[s];
-            while (le)
-            {
-              le->LinkAdded(*this, s, ap);
-              le = le->GetNextEdge();
-            }
-          }
+          deferred_ports.push_back(static_cast<tAbstractPort*>(&element));
         }
-        if (ap.link_edges)
+        else
         {
-          for (auto it = ap.link_edges->begin(); it != ap.link_edges->end(); ++it)
-          {
-            if ((*it)->GetSourceLink().length() > 0)
-            {
-              tAbstractPort* source = GetPort((*it)->GetSourceLink());
-              if (source)
-              {
-                (*it)->LinkAdded(*this, (*it)->GetSourceLink(), *source);
-              }
-            }
-            if ((*it)->GetTargetLink().length() > 0)
-            {
-              tAbstractPort* target = GetPort((*it)->GetTargetLink());
-              if (target)
-              {
-                (*it)->LinkAdded(*this, (*it)->GetTargetLink(), *target);
-              }
-            }
-          }
+          CheckLinkEdges(static_cast<tAbstractPort&>(element));
         }
       }
+
+      // link patterns create link edges - which are resolved later if link resolution is deferred
+      if (change_type == tRuntimeListener::tEvent::ADD && element.IsPort() && (!edge_target) && (!link_patterns.Empty()))
+      {
+        ConnectPatternMatches(static_cast<tAbstractPort&>(element));
+      }
     }
 
-    if (edge_target)
+    if (change_batch_depth > 0)
+    {
+      change_batch.push_back(tRuntimeListener::tChange(change_type, element, edge_target));
+    }
+    else if (edge_target)
     {
       assert(element.IsPort());
       for (auto it = runtime_listeners.Begin(); it != runtime_listeners.End(); ++it)
@@ -424,7 +802,23 @@ bool tRuntimeEnvironment::ShuttingDown()
 
 void tRuntimeEnvironment::UnregisterElement(tFrameworkElement& fe)
 {
-  tLock lock(structure_mutex);
+  internal::tStructureLock lock(structure_mutex, "tRuntimeEnvironment::UnregisterElement");
+  if (fe.IsPort())
+  {
+    if (fe.GetFlag(tFlag::PUBLISHED))
+    {
+      port_links.Remove(static_cast<tAbstractPort&>(fe));
+      pattern_link_edges.erase(static_cast<tAbstractPort*>(&fe));
+      if (link_resolution_defer_depth)
+      {
+        deferred_ports.erase(std::remove(deferred_ports.begin(), deferred_ports.end(), static_cast<tAbstractPort*>(&fe)), deferred_ports.end());
+      }
+    }
+    else
+    {
+      unpublished_port_count--;
+    }
+  }
   elements.Remove(fe.GetHandle());
 }
 
@@ -40,7 +40,9 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include <map>
+#include <unordered_map>
 #include <array>
+#include <atomic>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -48,6 +50,9 @@
 #include "core/tFrameworkElement.h"
 #include "core/tRuntimeListener.h"
 #include "core/internal/tFrameworkElementRegister.h"
+#include "core/internal/tPortLinkIndex.h"
+#include "core/internal/tNamePool.h"
+#include "core/internal/tLinkPatternIndex.h"
 
 //----------------------------------------------------------------------
 // Namespace declaration
@@ -88,6 +93,27 @@ enum class tSpecialRuntimeElement : size_t
  *
  * In order to modify the framework element hierarchy, a framework element
  * hierarchy lock must be acquired.
+ *
+ * Structure locking protocol:
+ * - All structural changes (adding children, initializing, linking, connecting, deleting)
+ *   are performed with the structure mutex (see GetStructureMutex()) acquired.
+ *   It has lock order level tLockOrderLevel::RUNTIME_REGISTER - so it may be acquired
+ *   after locking framework elements, but not the other way round.
+ * - Operations that involve several subtrees (e.g. edges, link edges and deletion) rely on
+ *   this mutex to be atomic - and it therefore remains the single lock for writers.
+ * - In addition, every child set is guarded by a child set mutex (lock order level
+ *   tLockOrderLevel::CHILD_SET). Framework elements are distributed among a fixed number of
+ *   these lock domains. Writers acquire the child set mutex of the element whose children,
+ *   child name index or child names they modify - after the structure mutex.
+ *   Child lookups (tFrameworkElement::GetChild() and lookups on ready elements) acquire
+ *   only this child set mutex (see tChildNameIndex). So they do not block on structural changes in other subtrees.
+ *   Structural changes themselves are still serialized by the structure mutex - also
+ *   in disjoint subtrees.
+ *   Child set mutexes are never nested - and no other framework lock except of the name
+ *   pool's is acquired while holding one.
+ * - Registering elements and looking up elements by handle do not require the mutex.
+ * - Lookups on ready elements (links, parents, child elements, ports) do not acquire it either,
+ *   as the structure of initialized elements does not change.
  */
 class tRuntimeEnvironment : public tFrameworkElement
 {
@@ -97,6 +123,11 @@ class tRuntimeEnvironment : public tFrameworkElement
 //----------------------------------------------------------------------
 public:
 
+  typedef internal::tFrameworkElementRegister::tVersion tStructureVersion;
+  typedef internal::tFrameworkElementRegister::tSnapshotEntry tElementSnapshotEntry;
+  typedef internal::tFrameworkElementRegister::tSnapshotCursor tElementSnapshotCursor;
+  typedef internal::tFrameworkElementRegister::tMetadataFilter tElementFilter;
+
   tRuntimeEnvironment();
 
   virtual ~tRuntimeEnvironment();
@@ -121,6 +152,45 @@ public:
    */
   void AddListener(tRuntimeListener& listener);
 
+  /*!
+   * Starts deferring link resolution:
+   * Link edges are not matched against ports as ports are published or link edges are created.
+   * Instead, ports published and link edges created in the meantime are recorded -
+   * and resolved in a single pass when EndDeferredLinkResolution() is called.
+   * This is a lot more efficient when e.g. a large application with many link edges is initialized.
+   * (calls may be nested; tFrameworkElement::InitAll() does this automatically)
+   */
+  void BeginDeferredLinkResolution();
+
+  /*!
+   * Ends deferring link resolution.
+   * If this is the outermost call, the recorded ports and link edges are resolved
+   * (ports against the link edge table, link edges against the index of published ports).
+   * Link edges and ports that existed before are not touched again.
+   * Runtime listeners are notified of all resulting connections in one batch.
+   */
+  void EndDeferredLinkResolution();
+
+  /*!
+   * Copies all framework elements that currently exist and match the specified filter to the specified buffer.
+   * As only metadata mirrored in the element register is scanned, this is a lot more efficient than checking every element.
+   *
+   * E.g. to obtain all connected output ports of type X:
+   *
+   *   tRuntimeEnvironment::tElementFilter filter;
+   *   filter.flag_mask = tFlag::PORT | tFlag::OUTPUT_PORT | tFlag::READY;
+   *   filter.flag_values = filter.flag_mask;
+   *   filter.data_type_uid = X.GetUid();
+   *   filter.min_outgoing_connections = 1;
+   *
+   * \param result_buffer Pointer to the first element of the result buffer
+   * \param max_elements Maximum number of elements to copy (size of result buffer)
+   * \param filter Filter that elements must match
+   * \param start_from_handle Handle to start from. Together with 'max_elements', can be used to get all elements with multiple calls to this function - using a small result buffer.
+   * \return Number of elements that were copied
+   */
+  size_t FindElements(tFrameworkElement** result_buffer, size_t max_elements, const tElementFilter& filter, tHandle start_from_handle = 0);
+
   /*!
    * Copies all framework elements that currently exist (including ports) to the specified buffer
    * (no support for output iterators, since typically only using arrays and vector makes sense)
@@ -176,6 +246,43 @@ public:
     return *special_runtime_elements[static_cast<size_t>(element)];
   }
 
+  /*!
+   * Copies entries of all framework elements that changed since the specified structure version to the specified buffer.
+   * In contrast to GetAllElements(), this does not acquire the structure mutex - and can therefore be used
+   * by tools to synchronize with large runtime environments without blocking structure changes.
+   * Entries with element NULL refer to removed elements.
+   *
+   * Typically used in this way:
+   *
+   *   tStructureVersion new_version = runtime.GetStructureVersion();
+   *   tElementSnapshotCursor cursor;
+   *   while (!cursor.Done())
+   *   {
+   *     size_t count = runtime.GetElementSnapshot(buffer, buffer_size, cursor, known_version);
+   *     ...
+   *   }
+   *   known_version = new_version;
+   *
+   * \param result_buffer Pointer to the first element of the result buffer
+   * \param max_entries Maximum number of entries to copy (size of result buffer)
+   * \param cursor Position in register to continue from. Is advanced to the slot after the last visited slot.
+   * \param changed_since_version Only return elements that changed after this structure version (0 returns all existing elements)
+   * \return Number of entries that were copied
+   */
+  size_t GetElementSnapshot(tElementSnapshotEntry* result_buffer, size_t max_entries, tElementSnapshotCursor& cursor, tStructureVersion changed_since_version = 0)
+  {
+    return elements.GetSnapshot(result_buffer, max_entries, cursor, changed_since_version);
+  }
+
+  /*!
+   * \param ports Return statistics on port handles? (otherwise statistics on handles of non-port elements are returned)
+   * \return Statistics on free, reusable and never used handle slots
+   */
+  internal::tFrameworkElementRegister::tSlotStatistics GetHandleSlotStatistics(bool ports)
+  {
+    return elements.GetSlotStatistics(ports);
+  }
+
   /*!
    * (IMPORTANT: This should not be called during static initialization)
    *
@@ -192,11 +299,23 @@ public:
   tAbstractPort* GetPort(tHandle port_handle);
 
   /*!
+   * Published ports are looked up in an index of all qualified links (no tree walk and no lock is necessary).
+   * As long as there are ports that have not been published yet, the framework element tree is searched
+   * for links not found in the index (this requires the structure mutex).
+   *
    * \param link_name (relative) Fully qualified name of port
    * \return Port with this name - or null if it does not exist. Port may not be initialized yet.
    */
   tAbstractPort* GetPort(const tString& link_name);
 
+  /*!
+   * \return Current structure version (incremented whenever framework elements are added, removed or changed)
+   */
+  tStructureVersion GetStructureVersion() const
+  {
+    return elements.GetVersion();
+  }
+
   /*!
    * \return Framework element hierarchy changing operations need to acquire a lock on this mutex
    * (Only lock runtime for minimal periods of time!)
@@ -213,6 +332,20 @@ public:
    */
   void RemoveListener(tRuntimeListener& listener);
 
+  /*!
+   * Looks up framework elements for many links at once.
+   * Results are identical to calling GetChildElement(link, false) for every link.
+   *
+   * Links are processed in sorted order - so that path prefixes shared by consecutive links
+   * (e.g. "/Main Thread/Control/Arm/" for all ports of a module) are only traversed once.
+   * Child names are matched in place (no strings are allocated for path elements).
+   *
+   * \param links Pointer to first link (absolute links - leading slash is optional)
+   * \param link_count Number of links
+   * \param result_buffer Buffer for results (needs to have space for 'link_count' entries). Contains the framework element for every link - or NULL if no element with this link exists.
+   */
+  void ResolveLinks(const tString* links, size_t link_count, tFrameworkElement** result_buffer);
+
   /*!
    * Using only the basic constructs from Finroc - things should shutdown cleanly automatically.
    *
@@ -233,16 +366,55 @@ private:
 
   friend class tFrameworkElement;
   friend class tAbstractPort;
+  friend class tStructureTransaction;
   friend class internal::tLinkEdge;
 
+  /*! (Source link, target link) of global link edge */
+  typedef std::pair<internal::tNamePool::tAtom, internal::tNamePool::tAtom> tLinkAtomPair;
+
+  /*! Hashes pair of link atoms */
+  struct tLinkAtomPairHash
+  {
+    size_t operator()(const tLinkAtomPair& links) const
+    {
+      std::hash<internal::tNamePool::tAtom> hash;
+      return hash(links.first) * 31 + hash(links.second);
+    }
+  };
+
   /*! Global register of all framework elements */
   internal::tFrameworkElementRegister elements;
 
-  /*! Edges dealing with linked ports */
-  std::map<std::string, internal::tLinkEdge*> link_edges;
+  /*!
+   * Edges dealing with linked ports - by atom of link they are interested in
+   * (first edge of singly linked list for each link)
+   */
+  std::unordered_map<internal::tNamePool::tAtom, internal::tLinkEdge*> link_edges;
+
+  /*!
+   * Global link edges (link edges with two links are added to this set by tAbstractPort) - by (source link, target link).
+   * Global link edges with a specific endpoint link can be found in 'link_edges'.
+   */
+  std::unordered_map<tLinkAtomPair, std::unique_ptr<internal::tLinkEdge>, tLinkAtomPairHash> global_link_edges;
+
+  /*! Link patterns that connect ports with matching links as they are published (added by tAbstractPort::ConnectByPattern()) */
+  internal::tLinkPatternIndex link_patterns;
+
+  /*! Link edge created for port whose link matched a link pattern */
+  struct tPatternLinkEdge
+  {
+    /*! Pattern pair that port's link matched */
+    const internal::tLinkPatternIndex::tPatternPair* pattern_pair;
+
+    /*! Link edge connecting port (by pointer) to the link at the other end */
+    std::unique_ptr<internal::tLinkEdge> edge;
+  };
 
-  /*! List of global link edges (link edges with two links are added to this list by tAbstractPort) */
-  std::vector<std::unique_ptr<internal::tLinkEdge>> global_link_edges;
+  /*!
+   * Link edges created for ports that matched link patterns - by port.
+   * Deleted when port is deleted - or when pattern is removed (see tAbstractPort::DisconnectByPattern()).
+   */
+  std::unordered_map<tAbstractPort*, std::vector<tPatternLinkEdge>> pattern_link_edges;
 
   /*! List with runtime listeners */
   rrlib::concurrent_containers::tSet < tRuntimeListener*, rrlib::concurrent_containers::tAllowDuplicates::NO, rrlib::thread::tNoMutex,
@@ -251,9 +423,30 @@ private:
   /*! Temporary buffer - may be used in synchronized context */
   std::string temp_buffer;
 
+  /*! Index of all published ports by qualified link */
+  internal::tPortLinkIndex port_links;
+
+  /*! Number of ports that were constructed - but have neither been published nor deleted yet */
+  std::atomic<size_t> unpublished_port_count;
+
   /*! Alternative roots for links (usually remote runtime environments mapped into this one) */
   std::vector<tFrameworkElement*> alternative_link_roots;
 
+  /*! Changes collected for runtime listeners while structure transactions are committed */
+  std::vector<tRuntimeListener::tChange> change_batch;
+
+  /*! Number of structure transactions currently being committed (nested) - changes are collected in 'change_batch' if > 0 */
+  size_t change_batch_depth;
+
+  /*! Number of nested BeginDeferredLinkResolution() calls - link edges are not resolved while > 0 */
+  size_t link_resolution_defer_depth;
+
+  /*! Ports published while link resolution is deferred */
+  std::vector<tAbstractPort*> deferred_ports;
+
+  /*! Link edges added while link resolution is deferred (with atom of link they were added for) */
+  std::vector<std::pair<internal::tNamePool::tAtom, internal::tLinkEdge*>> deferred_link_edges;
+
   /*! Mutex for framework element hierarchy */
   rrlib::thread::tRecursiveMutex structure_mutex;
 
@@ -279,17 +472,35 @@ private:
    */
   static void InitialInit();
 
+  /*!
+   * Notifies link edges interested in any of the port's links - and link edges referring to the port by pointer - that port has been published
+   * (may only be called with structure mutex acquired)
+   *
+   * \param port Port that has been published
+   */
+  void CheckLinkEdges(tAbstractPort& port);
+
+  /*!
+   * Creates link edges for all links of port that match patterns in 'link_patterns'
+   * (may only be called with structure mutex acquired)
+   *
+   * \param port Port whose links to check (must be published)
+   * \param pattern_pair If not NULL, only this pattern pair is checked
+   */
+  void ConnectPatternMatches(tAbstractPort& port, const internal::tLinkPatternIndex::tPatternPair* pattern_pair = NULL);
+
   /*!
    * (usually only called by LinkEdge)
    * Add link edge that is interested in specific link
    *
-   * \param link link that edge is interested in
+   * \param link Atom of (interned) link that edge is interested in
    * \param edge Edge to add
    */
-  void AddLinkEdge(const tString& link, internal::tLinkEdge& edge);
+  void AddLinkEdge(internal::tNamePool::tAtom link, internal::tLinkEdge& edge);
 
   /*!
    * Called before a framework element is initialized - can be used to create links etc. to this element etc.
+   * (collected in change batch - instead of notifying listeners immediately - while a structure transaction is committed)
    *
    * \param element Framework element that will be initialized soon
    */
@@ -298,6 +509,7 @@ private:
   /*!
    * Register framework element at RuntimeEnvironment.
    * This is done automatically and should not be called by a user.
+   * (does not acquire structure mutex, so that many threads may create elements concurrently)
    *
    * \param framework_element Element to register
    * \param port Is framework element a port?
@@ -309,10 +521,45 @@ private:
    * (usually only called by LinkEdge)
    * Remove link edge that is interested in specific link
    *
-   * \param link link that edge is interested in
-   * \param edge Edge to add
+   * \param link Atom of (interned) link that edge is interested in
+   * \param edge Edge to remove
+   */
+  void RemoveLinkEdge(internal::tNamePool::tAtom link, internal::tLinkEdge& edge);
+
+  /*!
+   * Removes pattern pair from 'link_patterns' - together with all link edges created for it.
+   * Disconnects the ports that these link edges connect.
+   * (may only be called with structure mutex acquired)
+   *
+   * \param pattern_pair Pattern pair to remove
+   */
+  void RemoveLinkPattern(const internal::tLinkPatternIndex::tPatternPair& pattern_pair);
+
+  /*!
+   * Helper for ResolveLinks(): Looks up child with a name equal to a part of a link
+   * (may only be called with structure mutex acquired)
+   *
+   * \param parent Parent element
+   * \param link Link
+   * \param name_start Index of first character of name in link
+   * \param name_length Length of name
+   * \return Child - or NULL if parent has no (non-deleted) child with this name
+   */
+  tFrameworkElement* ResolveLinkSegment(tFrameworkElement& parent, const tString& link, size_t name_start, size_t name_length);
+
+  /*!
+   * Starts collecting changes for runtime listeners instead of notifying them immediately
+   * (may only be called with structure mutex acquired)
+   */
+  void BeginChangeBatch();
+
+  /*!
+   * Stops collecting changes and notifies runtime listeners of all changes collected
+   * (in a single call to OnStructureChangeBatch() per listener).
+   * Changes to the same element or edge are coalesced beforehand (e.g. ADD followed by REMOVE cancels out).
+   * (may only be called with structure mutex acquired)
    */
-  void RemoveLinkEdge(const tString& link, internal::tLinkEdge& edge);
+  void EndChangeBatch();
 
   /*!
    * Called whenever a framework element was added/removed or changed
@@ -40,6 +40,7 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <cstddef>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -84,6 +85,27 @@ public:
     PRE_INIT //!< called with this constant before framework element is initialized
   };
 
+  /*! Single change in batch of changes (see OnStructureChangeBatch()) */
+  struct tChange
+  {
+    /*! Type of change */
+    tEvent change_type;
+
+    /*! FrameworkElement that changed (source of edge in case of edge change) */
+    tFrameworkElement* element;
+
+    /*! Target of edge in case of edge change - otherwise NULL */
+    tAbstractPort* edge_target;
+
+    tChange(tEvent change_type, tFrameworkElement& element, tAbstractPort* edge_target) :
+      change_type(change_type),
+      element(&element),
+      edge_target(edge_target)
+    {}
+  };
+
+  virtual ~tRuntimeListener() {}
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -112,6 +134,20 @@ private:
    */
   virtual void OnEdgeChange(tEvent change_type, tAbstractPort& source, tAbstractPort& target) = 0;
 
+  /*!
+   * Called with all changes performed in a structure transaction (see tStructureTransaction) - after it has been committed.
+   * Changes to the same element or edge are coalesced: CHANGE events are omitted if the element was added or is removed
+   * in the same batch - and elements (or edges) added and removed in the same batch are not reported at all (neither PRE_INIT).
+   * Listeners may override this in order to process changes more efficiently.
+   * The default implementation calls OnFrameworkElementChange() or OnEdgeChange() for every change.
+   *
+   * \param changes Pointer to first change
+   * \param change_count Number of changes
+   *
+   * (Is called in synchronized (Runtime) context in local runtime... so method should not block)
+   */
+  virtual void OnStructureChangeBatch(const tChange* changes, size_t change_count);
+
 };
 
 //----------------------------------------------------------------------
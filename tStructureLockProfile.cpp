@@ -0,0 +1,124 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tStructureLockProfile.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/tStructureLockProfile.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/log_messages.h"
+#include "core/internal/tStructureLock.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+/*!
+ * \param duration Duration
+ * \return Duration in milliseconds
+ */
+static double ToMilliseconds(std::chrono::nanoseconds duration)
+{
+  return duration.count() / 1000000.0;
+}
+
+void tStructureLockProfile::DumpToFile(const std::string& file_name, size_t max_call_sites)
+{
+  std::ofstream file(file_name.c_str());
+  if (!file)
+  {
+    FINROC_LOG_PRINT_STATIC(ERROR, "Could not open file '", file_name, "' for writing structure lock profile.");
+    throw std::runtime_error("Could not open file for writing structure lock profile");
+  }
+  file << GetReport(max_call_sites);
+}
+
+std::string tStructureLockProfile::GetReport(size_t max_call_sites)
+{
+  std::vector<internal::tStructureLock::tCallSiteStatistics> statistics = internal::tStructureLock::GetStatistics();
+  uint64_t acquisitions = 0;
+  std::chrono::nanoseconds total_wait_time(0), total_hold_time(0);
+  for (auto it = statistics.begin(); it != statistics.end(); ++it)
+  {
+    acquisitions += it->acquisitions;
+    total_wait_time += it->total_wait_time;
+    total_hold_time += it->total_hold_time;
+  }
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(3);
+  report << "Structure mutex: " << acquisitions << " acquisitions, " << ToMilliseconds(total_wait_time) << " ms waited, " << ToMilliseconds(total_hold_time) << " ms held" << std::endl;
+  report << "Top call sites by cumulative hold time:" << std::endl;
+  report << std::setw(12) << "held [ms]" << std::setw(12) << "max [ms]" << std::setw(12) << "waited [ms]" << std::setw(12) << "count" << "  call site" << std::endl;
+  for (size_t i = 0; i < statistics.size() && i < max_call_sites; i++)
+  {
+    const internal::tStructureLock::tCallSiteStatistics& entry = statistics[i];
+    report << std::setw(12) << ToMilliseconds(entry.total_hold_time) << std::setw(12) << ToMilliseconds(entry.max_hold_time) << std::setw(12) << ToMilliseconds(entry.total_wait_time)
+           << std::setw(12) << entry.acquisitions << "  " << entry.call_site << std::endl;
+  }
+  return report.str();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
@@ -0,0 +1,112 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tStructureLockProfile.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tStructureLockProfile
+ *
+ * \b tStructureLockProfile
+ *
+ * Provides reports on the statistics recorded for the runtime's
+ * structure mutex (acquisitions, wait and hold times per call site).
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__tStructureLockProfile_h__
+#define __core__tStructureLockProfile_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <string>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Structure mutex profile
+/*!
+ * Provides reports on the statistics recorded for the runtime's
+ * structure mutex (acquisitions, wait and hold times per call site).
+ * Statistics are only recorded if definitions::cPROFILE_STRUCTURE_LOCK is set -
+ * otherwise, reports are empty.
+ *
+ * The report lists the call sites with the largest cumulative hold times first.
+ */
+class tStructureLockProfile : private rrlib::util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * Writes report to file
+   *
+   * \param file_name Name of file to write report to
+   * \param max_call_sites Maximum number of call sites to include in report
+   * \throw Throws std::runtime_error if file cannot be written
+   */
+  static void DumpToFile(const std::string& file_name, size_t max_call_sites = 50);
+
+  /*!
+   * \param max_call_sites Maximum number of call sites to include in report
+   * \return Human-readable report on structure mutex usage
+   */
+  static std::string GetReport(size_t max_call_sites = 20);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  tStructureLockProfile() = delete;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,156 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tStructureTransaction.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ */
+//----------------------------------------------------------------------
+#include "core/tStructureTransaction.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tRuntimeEnvironment.h"
+#include "core/internal/tStructureLock.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+tStructureTransaction::tStructureTransaction() :
+  operations()
+{}
+
+tStructureTransaction::~tStructureTransaction()
+{
+  if (operations.size() > 0)
+  {
+    FINROC_LOG_PRINT(WARNING, "Discarding ", operations.size(), " structure operations that were not committed.");
+  }
+}
+
+void tStructureTransaction::Commit()
+{
+  if (operations.empty())
+  {
+    return;
+  }
+  std::vector<tOperation> committed_operations;
+  committed_operations.swap(operations);
+
+  tRuntimeEnvironment& runtime = tRuntimeEnvironment::GetInstance();
+  internal::tStructureLock lock(runtime.GetStructureMutex(), "tStructureTransaction::Commit");
+  runtime.BeginChangeBatch();
+  try
+  {
+    for (auto it = committed_operations.begin(); it != committed_operations.end(); ++it)
+    {
+      switch (it->type)
+      {
+      case tOperationType::INIT:
+        it->element->Init();
+        break;
+      case tOperationType::CONNECT_PORT:
+        static_cast<tAbstractPort*>(it->element)->ConnectTo(*it->partner_port, it->connect_direction, it->finstructed);
+        break;
+      case tOperationType::CONNECT_LINK:
+        static_cast<tAbstractPort*>(it->element)->ConnectTo(it->partner_link, it->connect_direction, it->finstructed);
+        break;
+      case tOperationType::DELETE:
+        it->element->ManagedDelete();
+        break;
+      }
+    }
+  }
+  catch (...)
+  {
+    runtime.EndChangeBatch();
+    throw;
+  }
+  runtime.EndChangeBatch();
+}
+
+void tStructureTransaction::Connect(tAbstractPort& port, tAbstractPort& to, tConnectDirection connect_direction, bool finstructed)
+{
+  tOperation operation(tOperationType::CONNECT_PORT, port);
+  operation.partner_port = &to;
+  operation.connect_direction = connect_direction;
+  operation.finstructed = finstructed;
+  operations.push_back(operation);
+}
+
+void tStructureTransaction::Connect(tAbstractPort& port, const tString& link_name, tConnectDirection connect_direction, bool finstructed)
+{
+  tOperation operation(tOperationType::CONNECT_LINK, port);
+  operation.partner_link = link_name;
+  operation.connect_direction = connect_direction;
+  operation.finstructed = finstructed;
+  operations.push_back(operation);
+}
+
+void tStructureTransaction::Delete(tFrameworkElement& element)
+{
+  operations.push_back(tOperation(tOperationType::DELETE, element));
+}
+
+void tStructureTransaction::Init(tFrameworkElement& element)
+{
+  operations.push_back(tOperation(tOperationType::INIT, element));
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
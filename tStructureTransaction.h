@@ -0,0 +1,209 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tStructureTransaction.h
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * \brief   Contains tStructureTransaction
+ *
+ * \b tStructureTransaction
+ *
+ * Collects structural changes (initialization of framework elements,
+ * connections, link edges, deletions) and applies them in one go.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __core__tStructureTransaction_h__
+#define __core__tStructureTransaction_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/port/tAbstractPort.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace finroc
+{
+namespace core
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Batch of structural changes
+/*!
+ * Collects structural changes (initialization of framework elements,
+ * connections, link edges, deletions) and applies them in one go.
+ *
+ * On Commit(), all operations are performed in the order they were added -
+ * with the runtime's structure mutex acquired only once.
+ * Runtime listeners are notified of all resulting changes (coalesced per element -
+ * see tRuntimeListener::OnStructureChangeBatch()) with a single call to
+ * tRuntimeListener::OnStructureChangeBatch() after the last operation.
+ * This is significantly more efficient than performing operations one by one -
+ * e.g. when loading a group with many connections.
+ *
+ * Framework elements are still created using their constructors.
+ * Their initialization (and thereby publishing), however, can be part of a transaction.
+ *
+ * Commit() is not atomic - there is no rollback: If an operation throws an exception,
+ * operations performed before remain in effect (and are reported to runtime listeners),
+ * while the remaining operations are discarded.
+ *
+ * Operations not committed are discarded when the transaction is destructed.
+ * A transaction may be used by one thread only.
+ */
+class tStructureTransaction : private rrlib::util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef tAbstractPort::tConnectDirection tConnectDirection;
+
+  tStructureTransaction();
+
+  ~tStructureTransaction();
+
+  /*!
+   * Applies all operations added to this transaction (in the order they were added).
+   * Afterwards, the transaction is empty and may be reused.
+   *
+   * \throw Rethrows exceptions of failing operations. Operations performed before are not rolled back - remaining operations are discarded.
+   */
+  void Commit();
+
+  /*!
+   * Adds connection of two ports to transaction (see tAbstractPort::ConnectTo)
+   *
+   * \param port Port to connect
+   * \param to Port to connect to
+   * \param connect_direction Direction for connection. "AUTO" should be appropriate for almost any situation.
+   * \param finstructed Was this connection created using finstruct (or loaded from XML file)?
+   */
+  void Connect(tAbstractPort& port, tAbstractPort& to, tConnectDirection connect_direction = tConnectDirection::AUTO, bool finstructed = false);
+
+  /*!
+   * Adds connection of port to link to transaction (creates link edge - see tAbstractPort::ConnectTo)
+   *
+   * \param port Port to connect
+   * \param link_name Link name of port to connect to (relative to parent framework element)
+   * \param connect_direction Direction for connection. "AUTO" should be appropriate for almost any situation.
+   * \param finstructed Was this connection created using finstruct (or loaded from XML file)?
+   */
+  void Connect(tAbstractPort& port, const tString& link_name, tConnectDirection connect_direction = tConnectDirection::AUTO, bool finstructed = false);
+
+  /*!
+   * Adds deletion of framework element (and all child elements) to transaction (see tFrameworkElement::ManagedDelete)
+   *
+   * \param element Element to delete
+   */
+  void Delete(tFrameworkElement& element);
+
+  /*!
+   * \return Number of operations in this transaction that have not been committed yet
+   */
+  size_t GetOperationCount() const
+  {
+    return operations.size();
+  }
+
+  /*!
+   * Adds initialization of framework element (and uninitialized elements in its subtree) to transaction (see tFrameworkElement::Init)
+   *
+   * \param element Element to initialize
+   */
+  void Init(tFrameworkElement& element);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Operation types */
+  enum class tOperationType
+  {
+    INIT,
+    CONNECT_PORT,
+    CONNECT_LINK,
+    DELETE
+  };
+
+  /*! Single operation in transaction */
+  struct tOperation
+  {
+    /*! Type of operation */
+    tOperationType type;
+
+    /*! Element that operation is performed on */
+    tFrameworkElement* element;
+
+    /*! Port to connect to (CONNECT_PORT only) */
+    tAbstractPort* partner_port;
+
+    /*! Link to connect to (CONNECT_LINK only) */
+    tString partner_link;
+
+    /*! Direction for connection (CONNECT_* only) */
+    tConnectDirection connect_direction;
+
+    /*! Was connection created using finstruct? (CONNECT_* only) */
+    bool finstructed;
+
+    tOperation(tOperationType type, tFrameworkElement& element) :
+      type(type),
+      element(&element),
+      partner_port(NULL),
+      partner_link(),
+      connect_direction(tConnectDirection::AUTO),
+      finstructed(false)
+    {}
+  };
+
+  /*! Operations that have not been committed yet */
+  std::vector<tOperation> operations;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,206 @@
+//
+// You received this file as part of Finroc
+// A framework for intelligent robot control
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    core/tests/benchmark_framework_element_register.cpp
+ *
+ * \author  Max Reichardt
+ *
+ * \date    2026-10-17
+ *
+ * Measures throughput of concurrent handle allocation (tFrameworkElementRegister::Add())
+ * and release (tFrameworkElementRegister::Remove()) with an increasing number of threads.
+ * Furthermore checks that all concurrently assigned handles are unique.
+ *
+ * Add() and Remove() do not access the elements they store - so all slots refer to the runtime element.
+ * (Get() would not find them, though, as it compares the handle stored in the element)
+ *
+ * Usage: benchmark_framework_element_register [handles per thread] [maximum number of threads]
+ */
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "core/tRuntimeEnvironment.h"
+#include "core/internal/tFrameworkElementRegister.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+using namespace finroc::core;
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+typedef std::chrono::steady_clock tClock;
+typedef internal::tFrameworkElementRegister tRegister;
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+const size_t cDEFAULT_HANDLES_PER_THREAD = 50000;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+/*! Work of one benchmark thread */
+struct tWorker
+{
+  /*! Register to add handles to */
+  tRegister* element_register;
+
+  /*! Element to register */
+  tFrameworkElement* element;
+
+  /*! Number of handles to allocate */
+  size_t handle_count;
+
+  /*! Allocated handles */
+  std::vector<tRegister::tHandle> handles;
+
+  tWorker(tRegister& element_register, tFrameworkElement& element, size_t handle_count) :
+    element_register(&element_register),
+    element(&element),
+    handle_count(handle_count),
+    handles()
+  {
+    handles.reserve(handle_count);
+  }
+
+  /*! Allocates handles */
+  void Add()
+  {
+    for (size_t i = 0; i < handle_count; i++)
+    {
+      handles.push_back(element_register->Add(*element, false));
+    }
+  }
+
+  /*! Releases handles */
+  void Remove()
+  {
+    for (auto it = handles.begin(); it != handles.end(); ++it)
+    {
+      element_register->Remove(*it);
+    }
+  }
+};
+
+/*!
+ * Runs function of all workers in separate threads
+ *
+ * \param workers Workers
+ * \param function Function to run
+ * \return Time until all threads completed
+ */
+static std::chrono::nanoseconds RunConcurrently(std::vector<tWorker>& workers, void (tWorker::*function)())
+{
+  std::vector<std::thread> threads;
+  tClock::time_point start = tClock::now();
+  for (auto it = workers.begin(); it != workers.end(); ++it)
+  {
+    threads.emplace_back(function, &(*it));
+  }
+  for (auto it = threads.begin(); it != threads.end(); ++it)
+  {
+    it->join();
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - start);
+}
+
+/*!
+ * \param operation_count Number of operations
+ * \param duration Duration
+ * \return Operations per second
+ */
+static double Throughput(size_t operation_count, std::chrono::nanoseconds duration)
+{
+  return operation_count / (std::max<int64_t>(duration.count(), 1) / 1000000000.0);
+}
+
+/*!
+ * Runs benchmark with specified number of threads on a fresh register
+ *
+ * \param thread_count Number of threads
+ * \param handles_per_thread Number of handles each thread allocates and releases
+ * \return True if all assigned handles were unique
+ */
+static bool RunBenchmark(size_t thread_count, size_t handles_per_thread)
+{
+  tRegister element_register;
+  tFrameworkElement& element = tRuntimeEnvironment::GetInstance();
+  std::vector<tWorker> workers;
+  workers.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++)
+  {
+    workers.emplace_back(element_register, element, handles_per_thread);
+  }
+
+  std::chrono::nanoseconds add_duration = RunConcurrently(workers, &tWorker::Add);
+
+  std::unordered_set<tRegister::tHandle> handles;
+  bool unique = true;
+  for (auto worker = workers.begin(); worker != workers.end(); ++worker)
+  {
+    for (auto it = worker->handles.begin(); it != worker->handles.end(); ++it)
+    {
+      unique &= handles.insert(*it).second;
+    }
+  }
+
+  std::chrono::nanoseconds remove_duration = RunConcurrently(workers, &tWorker::Remove);
+
+  size_t handle_count = thread_count * handles_per_thread;
+  std::cout << thread_count << " thread(s), " << handle_count << " handles: " << static_cast<size_t>(Throughput(handle_count, add_duration)) << " adds/s, "
+            << static_cast<size_t>(Throughput(handle_count, remove_duration)) << " removes/s" << (unique ? "" : " - DUPLICATE HANDLES") << std::endl;
+  return unique;
+}
+
+int main(int argc, char** argv)
+{
+  size_t handles_per_thread = argc > 1 ? static_cast<size_t>(atol(argv[1])) : cDEFAULT_HANDLES_PER_THREAD;
+  size_t max_threads = argc > 2 ? static_cast<size_t>(atol(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+  bool success = true;
+  for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+  {
+    size_t max_handles_per_thread = (tRegister::cFIRST_PORT_INDEX - 1) / thread_count;  // non-port slots of a fresh register
+    success &= RunBenchmark(thread_count, std::min(handles_per_thread, max_handles_per_thread));
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}